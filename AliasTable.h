@@ -0,0 +1,67 @@
+#ifndef __ALIASTABLE_H
+#define __ALIASTABLE_H
+
+#include <vector>
+
+/**
+ * Discrete distribution over 0..n-1 sampled in O(1) with Vose's alias method: n columns
+ * of height 1/n, each split between one outcome and its alias, built once in O(n).
+ */
+class AliasTable
+{
+  private:
+    std::vector<double> prob; // probability of keeping the column's own outcome
+    std::vector<int> alias;
+
+  public:
+    AliasTable() {}
+
+    // weights need not be normalized, but must not be negative or all zero
+    AliasTable(const std::vector<double>& weights) {
+        int n = weights.size();
+        double sum = 0;
+        for (double w : weights)
+            sum += w;
+        prob.assign(n, 1);
+        alias.resize(n);
+        std::vector<double> scaled(n);
+        std::vector<int> small, large;
+        for (int i = 0; i < n; i++) {
+            alias[i] = i;
+            scaled[i] = weights[i] / sum * n;
+            (scaled[i] < 1 ? small : large).push_back(i);
+        }
+        while (!small.empty() && !large.empty()) {
+            int s = small.back(), l = large.back();
+            small.pop_back();
+            prob[s] = scaled[s];
+            alias[s] = l;
+            scaled[l] -= 1 - scaled[s];
+            if (scaled[l] < 1) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+    }
+
+    int size() const { return prob.size(); }
+
+    // the outcome for a uniform u in [0,1)
+    int draw(double u) const {
+        u *= prob.size();
+        int i = (int)u;
+        return (u - i) < prob[i] ? i : alias[i];
+    }
+
+    // the probability of outcome i, recovered from the table
+    double getProbability(int i) const {
+        int n = prob.size();
+        double p = prob[i] / n;
+        for (int j = 0; j < n; j++)
+            if (alias[j] == i && j != i)
+                p += (1 - prob[j]) / n;
+        return p;
+    }
+};
+
+#endif
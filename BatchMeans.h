@@ -0,0 +1,143 @@
+#ifndef __BATCHMEANS_H
+#define __BATCHMEANS_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * Batch means of one output series, with the warm-up transient detected by MSER-5.
+ *
+ * Observations are averaged in batches of 5 as they arrive (the "5" of MSER-5). To keep
+ * memory bounded, when maxBatches batches are stored adjacent pairs are merged and the
+ * batch size doubles, so MSER then works on batches of 10, 20, ... observations.
+ */
+class BatchMeans
+{
+  public:
+    struct Estimate {
+        bool valid;              // false if the warm-up is not over or there are too few batches
+        double mean;
+        double halfWidth;        // of the confidence interval of the mean
+        long warmupObservations; // observations discarded as the warm-up transient
+    };
+
+  private:
+    int maxBatches;
+    long batchSize;
+    long count;
+    double partialSum;
+    long partialCount;
+    std::vector<double> batches;
+
+  public:
+    BatchMeans(int maxBatches = 4096) : maxBatches(maxBatches & ~1), batchSize(5), count(0), partialSum(0), partialCount(0) {}
+
+    long getCount() const { return count; }
+
+    void collect(double x) {
+        count++;
+        partialSum += x;
+        if (++partialCount < batchSize)
+            return;
+        batches.push_back(partialSum / batchSize);
+        partialSum = 0;
+        partialCount = 0;
+        if ((int)batches.size() >= maxBatches) {
+            for (int i = 0; i < maxBatches / 2; i++)
+                batches[i] = (batches[2*i] + batches[2*i+1]) / 2;
+            batches.resize(maxBatches / 2);
+            batchSize *= 2;
+        }
+    }
+
+    /**
+     * MSER truncation point: the number of leading batches whose removal minimizes the
+     * squared standard error of the remaining ones. Only the first half is searched;
+     * returns -1 if the minimum is at its end, i.e. the run is still in the warm-up.
+     */
+    int getTruncation() const {
+        int n = batches.size();
+        if (n < 2)
+            return -1;
+        double sum = 0, sqrSum = 0;
+        for (double y : batches) {
+            sum += y;
+            sqrSum += y * y;
+        }
+        int best = 0;
+        double bestScore = INFINITY;
+        for (int d = 0; d <= n / 2; d++) {
+            double m = n - d;
+            double score = (sqrSum - sum * sum / m) / (m * m);
+            if (score < bestScore) {
+                bestScore = score;
+                best = d;
+            }
+            sum -= batches[d];
+            sqrSum -= batches[d] * batches[d];
+        }
+        return best == n / 2 ? -1 : best;
+    }
+
+    // mean and confidence interval from numBatches batch means after the MSER truncation
+    Estimate getEstimate(int numBatches, double confidenceLevel) const {
+        Estimate e = {false, NAN, NAN, 0};
+        int d = getTruncation();
+        if (d < 0)
+            return e;
+        e.warmupObservations = d * batchSize;
+        int group = (batches.size() - d) / numBatches; // stored batches per CI batch
+        if (group == 0 || numBatches < 2)
+            return e;
+
+        // use the most recent numBatches*group batches, leftovers go with the warm-up
+        int first = batches.size() - numBatches * group;
+        double sum = 0, sqrSum = 0;
+        for (int b = 0; b < numBatches; b++) {
+            double groupSum = 0;
+            for (int i = 0; i < group; i++)
+                groupSum += batches[first + b * group + i];
+            double y = groupSum / group;
+            sum += y;
+            sqrSum += y * y;
+        }
+        double mean = sum / numBatches;
+        double var = std::max(0.0, (sqrSum - numBatches * mean * mean) / (numBatches - 1));
+        e.valid = true;
+        e.mean = mean;
+        e.halfWidth = studentQuantile((1 + confidenceLevel) / 2, numBatches - 1) * sqrt(var / numBatches);
+        return e;
+    }
+
+    // standard normal quantile (Acklam's rational approximation, relative error < 1.2e-9)
+    static double normalQuantile(double p) {
+        static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+        static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01};
+        static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+        static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00};
+        if (p < 0.02425) {
+            double q = sqrt(-2 * log(p));
+            return (((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) / ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+        }
+        if (p > 1 - 0.02425)
+            return -normalQuantile(1 - p);
+        double q = p - 0.5, r = q * q;
+        return (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q / (((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1);
+    }
+
+    // Student t quantile with dof degrees of freedom: exact for 1 and 2, otherwise the
+    // Cornish-Fisher expansion around the normal one (within 1% from 3 degrees of freedom)
+    static double studentQuantile(double p, int dof) {
+        if (dof == 1)
+            return tan(M_PI * (p - 0.5));
+        if (dof == 2)
+            return (2 * p - 1) / sqrt(2 * p * (1 - p));
+        double z = normalQuantile(p), z2 = z * z, v = dof;
+        return z + z * (z2 + 1) / (4 * v)
+                 + z * ((5 * z2 + 16) * z2 + 3) / (96 * v * v)
+                 + z * (((3 * z2 + 19) * z2 + 17) * z2 - 15) / (384 * v * v * v);
+    }
+};
+
+#endif
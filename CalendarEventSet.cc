@@ -0,0 +1,162 @@
+#include <omnetpp.h>
+#include <CalendarQueue.h>
+
+using namespace omnetpp;
+
+
+/**
+ * Future event set on a calendar queue (CalendarQueue.h) instead of the binary heap of the
+ * default cEventHeap: O(1) average insert and remove, which pays off with many pending
+ * timers, e.g. thousands of Sources each waiting for its next arrival (bench/FesBench.cc).
+ * Select it in omnetpp.ini with: futureeventset-class = "CalendarEventSet"
+ *
+ * Events are ordered as by cEventHeap: arrival time, then scheduling priority, then
+ * insertion order.
+ */
+class CalendarEventSet : public cFutureEventSet
+{
+  protected:
+    CalendarQueue<cEvent*> events;
+    std::vector<cEvent*> sorted; // for get(), built by sort()
+    long modifications = 0;      // changes to the set, so get() knows whether sorted is stale
+    long sortedAt = -1;          // modifications when sorted was built
+
+  public:
+    CalendarEventSet(const char *name = nullptr) : cFutureEventSet(name) {}
+    virtual ~CalendarEventSet();
+
+    virtual std::string str() const override;
+    virtual void forEachChild(cVisitor *v) override;
+
+    virtual void insert(cEvent *event) override;
+    virtual cEvent *peekFirst() const override;
+    virtual cEvent *removeFirst() override;
+    virtual void putBackFirst(cEvent *event) override;
+    virtual cEvent *remove(cEvent *event) override;
+    virtual bool isEmpty() const override;
+    virtual void clear() override;
+    virtual int getLength() const override;
+    virtual cEvent *get(int k) override;
+    virtual void sort() override;
+};
+
+Register_Class(CalendarEventSet);
+
+
+// cEvent::isScheduled() tests the private cEvent::heapIndex against -1, which only the kernel's
+// own cEventHeap may set. An explicit instantiation may name private members, so the template
+// below hands out a pointer to it: 0 marks an event in this set as scheduled, -1 as not.
+int cEvent::*heapIndexMember();
+
+template <int cEvent::*member>
+struct HeapIndexAccess {
+    friend int cEvent::*heapIndexMember() { return member; }
+};
+
+template struct HeapIndexAccess<&cEvent::heapIndex>;
+
+static void setScheduled(cEvent *event, bool scheduled)
+{
+    event->*heapIndexMember() = scheduled ? 0 : -1;
+}
+
+
+CalendarEventSet::~CalendarEventSet()
+{
+    clear();
+}
+
+std::string CalendarEventSet::str() const
+{
+    return "length=" + std::to_string(events.size());
+}
+
+void CalendarEventSet::forEachChild(cVisitor *v)
+{
+    sort();
+    for (auto event : sorted)
+        v->visit(event);
+}
+
+void CalendarEventSet::insert(cEvent *event)
+{
+    take(event);
+    setScheduled(event, true);
+    modifications++;
+    events.insert(event->getArrivalTime().raw(), event->getSchedulingPriority(), event);
+}
+
+cEvent *CalendarEventSet::peekFirst() const
+{
+    return events.isEmpty() ? nullptr : events.peekFirst().item;
+}
+
+cEvent *CalendarEventSet::removeFirst()
+{
+    if (events.isEmpty())
+        return nullptr;
+    cEvent *event = events.removeFirst();
+    modifications++;
+    setScheduled(event, false);
+    drop(event);
+    return event;
+}
+
+void CalendarEventSet::putBackFirst(cEvent *event)
+{
+    take(event);
+    setScheduled(event, true);
+    modifications++;
+    events.putBack(event->getArrivalTime().raw(), event->getSchedulingPriority(), event);
+}
+
+cEvent *CalendarEventSet::remove(cEvent *event)
+{
+    if (!events.remove(event->getArrivalTime().raw(), event))
+        return nullptr;
+    modifications++;
+    setScheduled(event, false);
+    drop(event);
+    return event;
+}
+
+bool CalendarEventSet::isEmpty() const
+{
+    return events.isEmpty();
+}
+
+void CalendarEventSet::clear()
+{
+    events.forEach([this](const CalendarQueue<cEvent*>::Entry& e) {
+        setScheduled(e.item, false);
+        dropAndDelete(e.item);
+    });
+    events.clear();
+    sorted.clear();
+    modifications++;
+}
+
+int CalendarEventSet::getLength() const
+{
+    return events.size();
+}
+
+// the k-th event in order; for the GUI, which calls sort() first
+cEvent *CalendarEventSet::get(int k)
+{
+    if (sortedAt != modifications)
+        sort();
+    return k >= 0 && k < (int)sorted.size() ? sorted[k] : nullptr;
+}
+
+void CalendarEventSet::sort()
+{
+    std::vector<CalendarQueue<cEvent*>::Entry> entries;
+    entries.reserve(events.size());
+    events.forEach([&](const CalendarQueue<cEvent*>::Entry& e) { entries.push_back(e); });
+    std::sort(entries.begin(), entries.end());
+    sorted.clear();
+    for (auto& e : entries)
+        sorted.push_back(e.item);
+    sortedAt = modifications;
+}
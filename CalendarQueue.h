@@ -0,0 +1,192 @@
+#ifndef __CALENDARQUEUE_H
+#define __CALENDARQUEUE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Calendar queue (R. Brown, 1988): a priority queue of items keyed by (time, priority,
+ * insertion order) for a discrete event simulation's future events. Time is divided in
+ * "days" of a fixed width, and a "year" of as many days as there are buckets; an item goes
+ * to the bucket of its day modulo the year. Removing the earliest item scans the buckets
+ * from the current day on, so when the width matches the spacing of the items both insert
+ * and remove take O(1) time on average, whatever the number of items, against O(log n)
+ * for a binary heap. The number of buckets follows the number of items, and the width is
+ * re-estimated from the earliest items every time the buckets are resized.
+ *
+ * Every bucket is a vector sorted latest first, so that its earliest item is popped from
+ * the back. Times are integers (raw simulation times) and must not be negative.
+ */
+template <typename T>
+class CalendarQueue
+{
+  public:
+    struct Entry {
+        int64_t time;
+        short priority; // smaller first, among equal times
+        int64_t seq;    // insertion order, smaller first among equal times and priorities
+        T item;
+
+        bool operator<(const Entry& o) const {
+            return time != o.time ? time < o.time : priority != o.priority ? priority < o.priority : seq < o.seq;
+        }
+    };
+
+  private:
+    enum { MIN_BUCKETS = 2, WIDTH_SAMPLE = 64 };
+
+    std::vector<std::vector<Entry>> buckets; // a power of two of them
+    size_t mask;           // buckets.size() - 1
+    int64_t width;         // of a day
+    size_t count;
+    int64_t nextSeq;       // of the next insert()
+    int64_t nextPutBack;   // of the next putBack(), decreasing so that it goes before everything else
+    int64_t lastTime;      // time of the last item removed: no item is earlier, except those put back
+
+    mutable size_t firstBucket; // bucket of the earliest item, if firstKnown
+    mutable bool firstKnown;
+
+    size_t bucketOf(int64_t time) const { return (size_t)(time / width) & mask; }
+
+    static bool later(const Entry& a, const Entry& b) { return b < a; }
+
+    void add(const Entry& e) {
+        if (firstKnown && e < buckets[firstBucket].back())
+            firstBucket = bucketOf(e.time);
+        std::vector<Entry>& b = buckets[bucketOf(e.time)];
+        b.insert(std::upper_bound(b.begin(), b.end(), e, later), e);
+        if (e.time < lastTime)
+            lastTime = e.time;
+        if (++count > 2 * buckets.size())
+            resize(2 * buckets.size());
+    }
+
+    void findFirst() const {
+        // one year from the current day: the first bucket whose earliest item is in the day being looked at
+        int64_t day = lastTime / width;
+        for (size_t i = 0; i <= mask; i++, day++) {
+            const std::vector<Entry>& b = buckets[(size_t)day & mask];
+            if (!b.empty() && b.back().time / width == day) {
+                firstBucket = (size_t)day & mask;
+                firstKnown = true;
+                return;
+            }
+        }
+        // nothing in the whole year, the items are sparse: the earliest of all the buckets
+        firstBucket = mask + 1;
+        for (size_t i = 0; i <= mask; i++)
+            if (!buckets[i].empty() && (firstBucket > mask || buckets[i].back() < buckets[firstBucket].back()))
+                firstBucket = i;
+        firstKnown = true;
+    }
+
+    // average distance between the earliest items, ignoring the outliers, or 0 if they all have the same time
+    int64_t estimateWidth(std::vector<Entry>& entries) const {
+        size_t n = std::min<size_t>(entries.size(), WIDTH_SAMPLE);
+        std::nth_element(entries.begin(), entries.begin() + (n - 1), entries.end());
+        std::sort(entries.begin(), entries.begin() + n);
+        double sum = 0;
+        for (size_t i = 1; i < n; i++)
+            sum += entries[i].time - entries[i - 1].time;
+        if (sum == 0)
+            return 0;
+        double mean = sum / (n - 1), trimmedSum = 0;
+        int trimmedCount = 0;
+        for (size_t i = 1; i < n; i++) {
+            int64_t gap = entries[i].time - entries[i - 1].time;
+            if (gap <= 2 * mean) {
+                trimmedSum += gap;
+                trimmedCount++;
+            }
+        }
+        return (int64_t)(3 * trimmedSum / trimmedCount) + 1;
+    }
+
+    void resize(size_t numBuckets) {
+        std::vector<Entry> entries;
+        entries.reserve(count);
+        for (auto& b : buckets)
+            entries.insert(entries.end(), b.begin(), b.end());
+        if (entries.size() >= 2) {
+            int64_t w = estimateWidth(entries);
+            if (w > 0)
+                width = w;
+        }
+        buckets.assign(numBuckets, std::vector<Entry>());
+        mask = numBuckets - 1;
+        firstKnown = false;
+        for (auto& e : entries) {
+            std::vector<Entry>& b = buckets[bucketOf(e.time)];
+            b.insert(std::upper_bound(b.begin(), b.end(), e, later), e);
+        }
+    }
+
+  public:
+    CalendarQueue() { clear(); }
+
+    void clear() {
+        buckets.assign(MIN_BUCKETS, std::vector<Entry>());
+        mask = MIN_BUCKETS - 1;
+        width = 1;
+        count = 0;
+        nextSeq = 0;
+        nextPutBack = -1;
+        lastTime = 0;
+        firstKnown = false;
+    }
+
+    bool isEmpty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    void insert(int64_t time, short priority, const T& item) { add(Entry{time, priority, nextSeq++, item}); }
+
+    // inserts an item that was just removed with removeFirst() back in first place
+    void putBack(int64_t time, short priority, const T& item) { add(Entry{time, priority, nextPutBack--, item}); }
+
+    // the earliest entry, the queue must not be empty
+    const Entry& peekFirst() const {
+        if (!firstKnown)
+            findFirst();
+        return buckets[firstBucket].back();
+    }
+
+    T removeFirst() {
+        if (!firstKnown)
+            findFirst();
+        std::vector<Entry>& b = buckets[firstBucket];
+        T item = b.back().item;
+        lastTime = b.back().time;
+        b.pop_back();
+        firstKnown = false;
+        if (--count < buckets.size() / 2 && buckets.size() > MIN_BUCKETS)
+            resize(buckets.size() / 2);
+        return item;
+    }
+
+    // removes the item inserted with this time, false if it is not in the queue
+    bool remove(int64_t time, const T& item) {
+        std::vector<Entry>& b = buckets[bucketOf(time)];
+        for (size_t i = 0; i < b.size(); i++) {
+            if (b[i].time == time && b[i].item == item) {
+                if (firstKnown && &b == &buckets[firstBucket] && i == b.size() - 1)
+                    firstKnown = false;
+                b.erase(b.begin() + i);
+                if (--count < buckets.size() / 2 && buckets.size() > MIN_BUCKETS)
+                    resize(buckets.size() / 2);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // calls f(entry) for every entry, in no particular order
+    template <typename F>
+    void forEach(F f) const {
+        for (auto& b : buckets)
+            for (auto& e : b)
+                f(e);
+    }
+};
+
+#endif
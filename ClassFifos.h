@@ -0,0 +1,85 @@
+#ifndef __CLASSFIFOS_H
+#define __CLASSFIFOS_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * One FIFO per class, each a ring buffer whose capacity doubles when it is full: push()
+ * and pop() are one slot write or read and an index update, with no allocation once the
+ * buffers have grown to the peak occupancy of their class. The heads of all the FIFOs
+ * sit in one contiguous vector indexed by class, 24 bytes each, so that hundreds of
+ * classes take a few KiB. T is meant to be a pointer or another trivially copyable handle.
+ */
+template <typename T>
+class ClassFifos
+{
+  private:
+    struct Fifo {
+        T *slots;       // capacity = mask + 1, a power of two (0 before the first push)
+        uint32_t mask;
+        uint32_t head;  // slot of the oldest element
+        uint32_t length;
+    };
+    std::vector<Fifo> fifos;
+
+    void grow(Fifo& f) {
+        uint32_t capacity = f.slots ? 2 * (f.mask + 1) : 4;
+        T *slots = new T[capacity];
+        for (uint32_t i = 0; i < f.length; i++)
+            slots[i] = f.slots[(f.head + i) & f.mask];
+        delete[] f.slots;
+        f.slots = slots;
+        f.mask = capacity - 1;
+        f.head = 0;
+    }
+
+    void clear() {
+        for (auto& f : fifos)
+            delete[] f.slots;
+        fifos.clear();
+    }
+
+  public:
+    ClassFifos(int n = 0) { resize(n); }
+    ~ClassFifos() { clear(); }
+    ClassFifos(const ClassFifos&) = delete;
+    ClassFifos& operator=(const ClassFifos&) = delete;
+
+    // n empty FIFOs, classes 0..n-1
+    void resize(int n) {
+        clear();
+        fifos.resize(n, Fifo{nullptr, 0, 0, 0});
+    }
+
+    int getNumClasses() const { return fifos.size(); }
+    int getLength(int c) const { return fifos[c].length; }
+    bool isEmpty(int c) const { return fifos[c].length == 0; }
+
+    // the i-th oldest element of class c, 0 is the next one popped
+    const T& get(int c, int i) const { const Fifo& f = fifos[c]; return f.slots[(f.head + i) & f.mask]; }
+
+    void push(int c, const T& x) {
+        Fifo& f = fifos[c];
+        if (f.length == (f.slots ? f.mask + 1 : 0))
+            grow(f);
+        f.slots[(f.head + f.length++) & f.mask] = x;
+    }
+
+    // removes and returns the oldest element of class c, which must not be empty
+    T pop(int c) {
+        Fifo& f = fifos[c];
+        T x = f.slots[f.head];
+        f.head = (f.head + 1) & f.mask;
+        f.length--;
+        return x;
+    }
+
+    // removes and returns the newest element of class c, which must not be empty
+    T popBack(int c) {
+        Fifo& f = fifos[c];
+        return f.slots[(f.head + --f.length) & f.mask];
+    }
+};
+
+#endif
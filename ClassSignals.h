@@ -0,0 +1,28 @@
+#ifndef __CLASSSIGNALS_H
+#define __CLASSSIGNALS_H
+
+#include <omnetpp.h>
+#include <string>
+#include <vector>
+
+/**
+ * Registers the per-class signals "<name>0" ... "<name><numPrio-1>" of a module and
+ * gives each of them the result recorders declared by @statisticTemplate[name] in the
+ * module's NED file. The returned vector is indexed by priority, so emitting a per-class
+ * value is a plain lookup whatever the number of classes. The Queue's per-server busy<k>
+ * signals are registered the same way, with the number of servers as numPrio.
+ */
+inline std::vector<omnetpp::simsignal_t> registerClassSignals(omnetpp::cComponent *component, const char *name, int numPrio)
+{
+    omnetpp::cProperty *statisticTemplate = component->getProperties()->get("statisticTemplate", name);
+    std::vector<omnetpp::simsignal_t> signals(numPrio);
+    for (int i = 0; i < numPrio; i++) {
+        std::string signalName = name + std::to_string(i);
+        signals[i] = omnetpp::cComponent::registerSignal(signalName.c_str());
+        if (statisticTemplate)
+            omnetpp::getEnvir()->addResultRecorders(component, signals[i], signalName.c_str(), statisticTemplate);
+    }
+    return signals;
+}
+
+#endif
@@ -0,0 +1,145 @@
+#include <omnetpp.h>
+#include <BatchMeans.h>
+
+using namespace omnetpp;
+
+
+/**
+ * Ends the run as soon as the per-class estimates have converged: it listens to the
+ * per-class signals "<name><k>" (e.g. responseTime<k> of the Sink, queueingTime<k> of
+ * the Queue) emitted anywhere in the parent module, keeps their batch means with the
+ * warm-up removed by MSER-5 (BatchMeans.h), and every checkInterval calls
+ * endSimulation() once every confidence interval is narrower than relativeHalfWidth
+ * times its mean. sim-time-limit stays the upper bound for runs that never converge.
+ */
+class ConvergenceMonitor : public cSimpleModule, public cListener
+{
+  private:
+    struct Series {
+        std::string name;
+        BatchMeans batchMeans;
+        BatchMeans::Estimate estimate;
+    };
+    std::vector<Series> series;
+    std::vector<int> seriesOfSignal; // indexed by signal ID, -1 if not watched
+    std::vector<simsignal_t> watched;
+
+    double relativeHalfWidth;
+    double confidenceLevel;
+    int numBatches;
+    long minObservations;
+    simtime_t checkInterval;
+    cMessage *checkMsg;
+    simtime_t convergenceTime;
+
+  public:
+    ConvergenceMonitor();
+    virtual ~ConvergenceMonitor();
+
+  protected:
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, const SimTime& t, cObject *details) override;
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, double d, cObject *details) override;
+    virtual bool hasConverged();
+};
+
+Define_Module(ConvergenceMonitor);
+
+
+ConvergenceMonitor::ConvergenceMonitor()
+{
+    checkMsg = nullptr;
+}
+
+ConvergenceMonitor::~ConvergenceMonitor()
+{
+    cancelAndDelete(checkMsg);
+    for (auto signal : watched)
+        if (getParentModule()->isSubscribed(signal, this))
+            getParentModule()->unsubscribe(signal, this);
+}
+
+void ConvergenceMonitor::initialize()
+{
+    relativeHalfWidth = par("relativeHalfWidth");
+    confidenceLevel = par("confidenceLevel");
+    numBatches = par("numBatches");
+    minObservations = par("minObservations");
+    checkInterval = par("checkInterval").doubleValue();
+    int numPrio = par("numPrio");
+    int maxStoredBatches = par("maxStoredBatches");
+    if (maxStoredBatches < 2)
+        throw cRuntimeError("maxStoredBatches must be at least 2, got %d", maxStoredBatches);
+    convergenceTime = -1;
+
+    // emits propagate up the module tree: listening on the parent catches the Sink and the Queue
+    for (auto& name : cStringTokenizer(par("signals")).asVector()) {
+        for (int i = 0; i < numPrio; i++) {
+            std::string signalName = name + std::to_string(i);
+            simsignal_t signal = registerSignal(signalName.c_str());
+            if (signal >= (int)seriesOfSignal.size())
+                seriesOfSignal.resize(signal + 1, -1);
+            seriesOfSignal[signal] = series.size();
+            series.push_back(Series{signalName, BatchMeans(maxStoredBatches), BatchMeans::Estimate{false, NAN, NAN, 0}});
+            getParentModule()->subscribe(signal, this);
+            watched.push_back(signal);
+        }
+    }
+
+    checkMsg = new cMessage("convergence-check");
+    scheduleAt(simTime() + checkInterval, checkMsg);
+}
+
+void ConvergenceMonitor::receiveSignal(cComponent *source, simsignal_t signalID, const SimTime& t, cObject *details)
+{
+    receiveSignal(source, signalID, t.dbl(), details);
+}
+
+void ConvergenceMonitor::receiveSignal(cComponent *source, simsignal_t signalID, double d, cObject *details)
+{
+    if (signalID < (int)seriesOfSignal.size() && seriesOfSignal[signalID] >= 0)
+        series[seriesOfSignal[signalID]].batchMeans.collect(d);
+}
+
+void ConvergenceMonitor::handleMessage(cMessage *msg)
+{
+    ASSERT(msg == checkMsg);
+
+    if (hasConverged()) {
+        convergenceTime = simTime();
+        EV << "All " << series.size() << " confidence intervals are within " << relativeHalfWidth * 100 << "% of their mean, ending the run" << endl;
+        endSimulation();
+    }
+    scheduleAt(simTime() + checkInterval, checkMsg);
+}
+
+// refreshes the estimates of every series, true if all of them are precise enough
+bool ConvergenceMonitor::hasConverged()
+{
+    bool converged = true;
+    for (auto& s : series) {
+        s.estimate = s.batchMeans.getEstimate(numBatches, confidenceLevel);
+        if (!s.estimate.valid || s.batchMeans.getCount() < minObservations || s.estimate.halfWidth > relativeHalfWidth * fabs(s.estimate.mean)) {
+            EV_DETAIL << s.name << " has not converged yet (" << s.batchMeans.getCount() << " observations)" << endl;
+            converged = false;
+        }
+    }
+    return converged;
+}
+
+void ConvergenceMonitor::finish()
+{
+    if (convergenceTime < SIMTIME_ZERO)
+        hasConverged(); // the run ended on its time limit, record the estimates reached so far
+
+    recordScalar("converged", convergenceTime >= SIMTIME_ZERO);
+    recordScalar("convergenceTime", convergenceTime >= SIMTIME_ZERO ? convergenceTime : simTime());
+    for (auto& s : series) {
+        recordScalar((s.name + ":bmMean").c_str(), s.estimate.mean);
+        recordScalar((s.name + ":bmHalfWidth").c_str(), s.estimate.halfWidth);
+        recordScalar((s.name + ":warmupObservations").c_str(), s.estimate.warmupObservations);
+        recordScalar((s.name + ":observations").c_str(), s.batchMeans.getCount());
+    }
+}
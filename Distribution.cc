@@ -0,0 +1,190 @@
+#include <Distribution.h>
+#include <algorithm>
+#include <fstream>
+
+using namespace omnetpp;
+
+
+Distribution::Distribution(double mean)
+{
+    kind = EXPONENTIAL;
+    a = mean;
+    b = 0;
+    k = 1;
+    hasSpareNormal = false;
+    spareNormal = 0;
+}
+
+Distribution Distribution::parse(const std::string& spec)
+{
+    Distribution d;
+    size_t open = spec.find('(');
+    if (open == std::string::npos) { // a plain number, the exponential mean
+        char *end;
+        d.a = strtod(spec.c_str(), &end);
+        if (spec.empty() || *end)
+            throw cRuntimeError("Invalid distribution \"%s\"", spec.c_str());
+        return d;
+    }
+    if (spec.back() != ')')
+        throw cRuntimeError("Invalid distribution \"%s\": missing ')'", spec.c_str());
+    std::string name = spec.substr(0, open);
+    std::string args = spec.substr(open + 1, spec.size() - open - 2);
+
+    if (name == "empirical") {
+        std::ifstream in(args);
+        if (!in)
+            throw cRuntimeError("Invalid distribution \"%s\": cannot open %s", spec.c_str(), args.c_str());
+        double value;
+        while (in >> value)
+            d.table.push_back(value);
+        if (!in.eof() || d.table.size() < 2)
+            throw cRuntimeError("Invalid distribution \"%s\": %s must contain at least two numbers and nothing else", spec.c_str(), args.c_str());
+        std::sort(d.table.begin(), d.table.end());
+        d.kind = EMPIRICAL;
+        return d;
+    }
+
+    std::replace(args.begin(), args.end(), ',', ' ');
+    std::vector<double> p = cStringTokenizer(args.c_str()).asDoubleVector();
+    auto expect = [&](bool ok) {
+        if (!ok)
+            throw cRuntimeError("Invalid distribution \"%s\": wrong number or range of arguments", spec.c_str());
+    };
+
+    if (name == "exp") {
+        expect(p.size() == 1 && p[0] > 0);
+        d.a = p[0];
+    }
+    else if (name == "det") {
+        expect(p.size() == 1 && p[0] >= 0);
+        d.kind = DETERMINISTIC;
+        d.a = p[0];
+    }
+    else if (name == "erlang") {
+        expect(p.size() == 2 && p[0] >= 1 && p[0] == (int)p[0] && p[1] > 0);
+        d.kind = ERLANG;
+        d.k = p[0];
+        d.a = p[1];
+    }
+    else if (name == "hyperexp") {
+        expect(p.size() >= 2 && p.size() % 2 == 0);
+        std::vector<double> probs;
+        double sum = 0;
+        for (size_t i = 0; i < p.size(); i += 2) {
+            expect(p[i] >= 0 && p[i + 1] > 0);
+            probs.push_back(p[i]);
+            d.table.push_back(p[i + 1]);
+            sum += p[i];
+        }
+        expect(fabs(sum - 1) < 1e-9);
+        d.kind = HYPEREXPONENTIAL;
+        d.branches = AliasTable(probs);
+    }
+    else if (name == "lognormal") {
+        expect(p.size() == 2 && p[1] >= 0);
+        d.kind = LOGNORMAL;
+        d.a = p[0];
+        d.b = p[1];
+    }
+    else if (name == "pareto") {
+        expect(p.size() == 2 && p[0] > 0 && p[1] > 0);
+        d.kind = PARETO;
+        d.a = p[0];
+        d.b = p[1];
+    }
+    else
+        throw cRuntimeError("Invalid distribution \"%s\": unknown '%s', use exp, det, erlang, hyperexp, lognormal, pareto or empirical", spec.c_str(), name.c_str());
+    return d;
+}
+
+std::vector<Distribution> Distribution::parseList(const char *specs)
+{
+    // split on whitespace outside parentheses, so that "erlang(2, 0.3)" stays one spec
+    std::vector<Distribution> result;
+    std::string spec;
+    int depth = 0;
+    for (const char *s = specs; ; s++) {
+        if (*s == '\0' || (isspace((unsigned char)*s) && depth == 0)) {
+            if (!spec.empty())
+                result.push_back(parse(spec));
+            spec.clear();
+            if (*s == '\0')
+                break;
+            continue;
+        }
+        if (*s == '(')
+            depth++;
+        else if (*s == ')')
+            depth--;
+        if (!isspace((unsigned char)*s))
+            spec += *s;
+    }
+    return result;
+}
+
+// standard normal with the polar method: one logarithm for every two values
+double Distribution::normal(cRNG *rng)
+{
+    if (hasSpareNormal) {
+        hasSpareNormal = false;
+        return spareNormal;
+    }
+    double u, v, s;
+    do {
+        u = 2 * rng->doubleRand() - 1;
+        v = 2 * rng->doubleRand() - 1;
+        s = u * u + v * v;
+    } while (s >= 1 || s == 0);
+    double f = sqrt(-2 * log(s) / s);
+    spareNormal = v * f;
+    hasSpareNormal = true;
+    return u * f;
+}
+
+double Distribution::getMean() const
+{
+    switch (kind) {
+        case EXPONENTIAL: case DETERMINISTIC: case ERLANG: return a;
+        case HYPEREXPONENTIAL: {
+            double mean = 0;
+            for (int i = 0; i < (int)table.size(); i++)
+                mean += branches.getProbability(i) * table[i];
+            return mean;
+        }
+        case LOGNORMAL: return exp(a + b * b / 2);
+        case PARETO: return a > 1 ? a * b / (a - 1) : INFINITY;
+        case EMPIRICAL: {
+            double sum = 0;
+            for (size_t i = 0; i + 1 < table.size(); i++)
+                sum += (table[i] + table[i + 1]) / 2;
+            return sum / (table.size() - 1);
+        }
+    }
+    return NAN;
+}
+
+double Distribution::getSecondMoment() const
+{
+    switch (kind) {
+        case EXPONENTIAL: return 2 * a * a;
+        case DETERMINISTIC: return a * a;
+        case ERLANG: return a * a * (1 + 1.0 / k);
+        case HYPEREXPONENTIAL: {
+            double m2 = 0;
+            for (int i = 0; i < (int)table.size(); i++)
+                m2 += branches.getProbability(i) * 2 * table[i] * table[i];
+            return m2;
+        }
+        case LOGNORMAL: return exp(2 * a + 2 * b * b);
+        case PARETO: return a > 2 ? a * b * b / (a - 2) : INFINITY;
+        case EMPIRICAL: {
+            // each interval between consecutive sorted values is uniform, with probability 1/(n-1)
+            double sum = 0;
+            for (size_t i = 0; i + 1 < table.size(); i++)
+                sum += (table[i] * table[i] + table[i] * table[i + 1] + table[i + 1] * table[i + 1]) / 3;
+            return sum / (table.size() - 1);
+        }
+    }
+    return NAN;
+}
@@ -0,0 +1,78 @@
+#ifndef __DISTRIBUTION_H
+#define __DISTRIBUTION_H
+
+#include <omnetpp.h>
+#include <cmath>
+#include <AliasTable.h>
+#include <string>
+#include <vector>
+
+/**
+ * A random variate for the per-class interArrivalTimes / serviceTimes parameters, parsed
+ * once from a spec in initialize() and then drawn without parsing or allocating:
+ *
+ *   0.25                     exponential with mean 0.25 (the plain number of the old syntax)
+ *   exp(0.25)                exponential with mean 0.25
+ *   det(0.25)                always 0.25
+ *   erlang(3,0.25)           Erlang-3 with mean 0.25
+ *   hyperexp(0.9,0.1,0.1,2)  exponential with mean 0.1 with probability 0.9, 2 otherwise
+ *   lognormal(-2,0.5)        exp(N(-2, 0.5^2)), m and w of the normal like OMNeT++'s lognormal()
+ *   pareto(1.5,0.1)          Pareto with shape 1.5 and scale (minimum) 0.1
+ *   empirical(trace.txt)     inverse CDF of the values in the file, linearly interpolated
+ *
+ * The branch of a hyperexponential is picked with an alias table, the empirical inverse
+ * CDF is a sorted table, and the lognormal caches the second normal of each polar pair,
+ * so that every draw costs about one logarithm, like the exponential one.
+ */
+class Distribution
+{
+  public:
+    enum Kind { EXPONENTIAL, DETERMINISTIC, ERLANG, HYPEREXPONENTIAL, LOGNORMAL, PARETO, EMPIRICAL };
+
+  private:
+    Kind kind;
+    double a, b; // mean (exponential, erlang), value (det), m and w (lognormal), shape and scale (pareto)
+    int k;       // erlang stages
+    std::vector<double> table;  // branch means (hyperexp), sorted values (empirical)
+    AliasTable branches;        // of the hyperexp
+    bool hasSpareNormal;
+    double spareNormal;
+
+    double normal(omnetpp::cRNG *rng);
+
+  public:
+    Distribution(double mean = 1);
+
+    // throws cRuntimeError on a malformed spec
+    static Distribution parse(const std::string& spec);
+    // the whitespace-separated specs of a parameter, e.g. "0.2 erlang(2,0.3) det(1)"
+    static std::vector<Distribution> parseList(const char *specs);
+
+    Kind getKind() const { return kind; }
+    double getMean() const; // infinite for a Pareto with shape <= 1
+    double getSecondMoment() const; // E[X^2], infinite for a Pareto with shape <= 2
+
+    double draw(omnetpp::cRNG *rng) {
+        switch (kind) {
+            case EXPONENTIAL: return omnetpp::exponential(rng, a);
+            case DETERMINISTIC: return a;
+            case ERLANG: {
+                double product = 1;
+                for (int i = 0; i < k; i++)
+                    product *= rng->doubleRandNonz();
+                return -a / k * log(product);
+            }
+            case HYPEREXPONENTIAL: return omnetpp::exponential(rng, table[branches.draw(rng->doubleRand())]);
+            case LOGNORMAL: return exp(a + b * normal(rng));
+            case PARETO: return b * pow(rng->doubleRandNonz(), -1 / a);
+            case EMPIRICAL: {
+                double x = rng->doubleRand() * (table.size() - 1);
+                int i = (int)x;
+                return table[i] + (x - i) * (table[i + 1] - table[i]);
+            }
+        }
+        return 0;
+    }
+};
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef __FAIRQUEUEING_H
+#define __FAIRQUEUEING_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <ClassFifos.h>
+#include <IndexedHeap.h>
+
+/**
+ * Fair alternatives to strict priority for choosing the class served next, kept alongside
+ * the per-class FIFOs of a Queue: push() when a job of a class enters the queue with its
+ * size (service time), next() for the class to serve, then pop() when its oldest job leaves
+ * the queue, or popBack() when its newest one is dropped. Classes are 0..n-1, each with a
+ * weight > 0: its share of the service while it is backlogged.
+ */
+
+/**
+ * Weighted fair queueing, self-clocked (Golestani's SCFQ): a job gets the virtual finish
+ * time max(V, F) + size/weight, F being the finish time of the previous job of its class
+ * and V the finish time of the last job picked, and the job with the earliest finish time
+ * is served first. Finish times grow within a class, so only the oldest job of every
+ * class is compared, in a heap of the non-empty classes: O(log n) per job.
+ */
+class WfqScheduler
+{
+  private:
+    ClassFifos<double> finishTimes;   // of the queued jobs, per class
+    std::vector<double> weights;
+    std::vector<double> lastFinish;   // finish time of the latest job of the class
+    IndexedHeap<std::pair<double, int>> heads; // non-empty classes by (-finish time, -class) of their oldest job
+    double virtualTime;
+
+    void updateHead(int c) {
+        if (finishTimes.isEmpty(c))
+            heads.remove(c);
+        else
+            heads.update(c, std::make_pair(-finishTimes.get(c, 0), -c));
+    }
+
+  public:
+    void resize(const std::vector<double>& weights) {
+        this->weights = weights;
+        finishTimes.resize(weights.size());
+        lastFinish.assign(weights.size(), 0);
+        heads.resize(weights.size());
+        virtualTime = 0;
+    }
+
+    void push(int c, double size) {
+        double finish = std::max(virtualTime, lastFinish[c]) + size / weights[c];
+        lastFinish[c] = finish;
+        finishTimes.push(c, finish);
+        if (finishTimes.getLength(c) == 1)
+            heads.push(c, std::make_pair(-finish, -c));
+    }
+
+    // the class whose oldest job has the earliest finish time (the lowest class among equals), -1 if all are empty
+    int next() const { return heads.isEmpty() ? -1 : heads.top(); }
+
+    void pop(int c) {
+        virtualTime = finishTimes.pop(c);
+        updateHead(c);
+    }
+
+    void popBack(int c) {
+        finishTimes.popBack(c);
+        // as if the dropped job had never arrived: a job of an otherwise empty class starts at the virtual time
+        lastFinish[c] = finishTimes.isEmpty(c) ? virtualTime : finishTimes.get(c, finishTimes.getLength(c) - 1);
+        if (finishTimes.isEmpty(c))
+            heads.remove(c);
+    }
+};
+
+/**
+ * Deficit round robin (Shreedhar and Varghese): the non-empty classes take turns in a
+ * circular list, and at its turn a class gets quantum*weight more credit and serves its
+ * jobs for as long as the credit covers the size of the oldest one. The credit of a class
+ * that empties is lost. O(1) per job once the quantum covers the largest jobs.
+ */
+class DrrScheduler
+{
+  private:
+    ClassFifos<double> sizes;      // of the queued jobs, per class
+    std::vector<double> quanta;    // quantum*weight, per class
+    std::vector<double> deficits;
+    std::vector<int> succ, pred;   // circular list of the non-empty classes
+    int current;                   // class whose turn it is, -1 if all are empty
+    bool credited;                 // the current class got its quantum for this turn
+
+    // c became empty: it leaves the list, and if it was its turn the next class has it
+    void unlink(int c) {
+        succ[pred[c]] = succ[c];
+        pred[succ[c]] = pred[c];
+        if (current == c) {
+            current = succ[c] == c ? -1 : succ[c];
+            credited = false;
+        }
+        deficits[c] = 0;
+    }
+
+  public:
+    void resize(const std::vector<double>& weights, double quantum) {
+        int n = weights.size();
+        sizes.resize(n);
+        quanta.resize(n);
+        for (int c = 0; c < n; c++)
+            quanta[c] = quantum * weights[c];
+        deficits.assign(n, 0);
+        succ.assign(n, -1);
+        pred.assign(n, -1);
+        current = -1;
+        credited = false;
+    }
+
+    void push(int c, double size) {
+        sizes.push(c, size);
+        if (sizes.getLength(c) > 1)
+            return;
+        // a class that becomes non-empty has the last turn of the round
+        if (current == -1) {
+            succ[c] = pred[c] = c;
+            current = c;
+            credited = false;
+        }
+        else {
+            succ[c] = current;
+            pred[c] = pred[current];
+            succ[pred[c]] = c;
+            pred[current] = c;
+        }
+    }
+
+    // the class to serve, -1 if all are empty; gives the quantum of the classes whose turn comes
+    int next() {
+        if (current == -1)
+            return -1;
+        for (;;) {
+            if (!credited) {
+                deficits[current] += quanta[current];
+                credited = true;
+            }
+            if (sizes.get(current, 0) <= deficits[current])
+                return current;
+            current = succ[current];
+            credited = false;
+        }
+    }
+
+    // the oldest job of c, the class returned by next(), leaves the queue
+    void pop(int c) {
+        deficits[c] -= sizes.pop(c);
+        if (sizes.isEmpty(c))
+            unlink(c);
+    }
+
+    void popBack(int c) {
+        sizes.popBack(c);
+        if (sizes.isEmpty(c))
+            unlink(c);
+    }
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef __INDEXEDHEAP_H
+#define __INDEXEDHEAP_H
+
+#include <utility>
+#include <vector>
+
+/**
+ * Binary max-heap over the items 0..n-1, each with a key, that knows where every item
+ * is: the largest key is found in O(1), and any item can be pushed, re-keyed or removed
+ * in O(log n). Meant for small sets such as the servers of a Queue.
+ */
+template <typename Key>
+class IndexedHeap
+{
+  private:
+    std::vector<int> heap; // items, heap[0] has the largest key
+    std::vector<int> pos;  // position of every item in heap, -1 if not in it
+    std::vector<Key> keys;
+
+    void place(int i, int item) {
+        heap[i] = item;
+        pos[item] = i;
+    }
+
+    void siftUp(int i) {
+        int item = heap[i];
+        while (i > 0 && keys[heap[(i - 1) / 2]] < keys[item]) {
+            place(i, heap[(i - 1) / 2]);
+            i = (i - 1) / 2;
+        }
+        place(i, item);
+    }
+
+    void siftDown(int i) {
+        int item = heap[i];
+        int n = heap.size();
+        while (2 * i + 1 < n) {
+            int child = 2 * i + 1;
+            if (child + 1 < n && keys[heap[child]] < keys[heap[child + 1]])
+                child++;
+            if (!(keys[item] < keys[heap[child]]))
+                break;
+            place(i, heap[child]);
+            i = child;
+        }
+        place(i, item);
+    }
+
+  public:
+    IndexedHeap(int n = 0) { resize(n); }
+
+    // the items become 0..n-1, the heap is emptied
+    void resize(int n) {
+        heap.clear();
+        pos.assign(n, -1);
+        keys.resize(n);
+    }
+
+    // the items become 0..n-1 for a larger n, the heap is kept
+    void grow(int n) {
+        pos.resize(n, -1);
+        keys.resize(n);
+    }
+
+    bool isEmpty() const { return heap.empty(); }
+    int size() const { return heap.size(); }
+    bool contains(int item) const { return pos[item] != -1; }
+
+    // the item with the largest key, the heap must not be empty
+    int top() const { return heap[0]; }
+    const Key& getKey(int item) const { return keys[item]; }
+
+    void push(int item, const Key& key) {
+        keys[item] = key;
+        heap.push_back(item);
+        siftUp(heap.size() - 1);
+    }
+
+    void update(int item, const Key& key) {
+        keys[item] = key;
+        siftUp(pos[item]);
+        siftDown(pos[item]);
+    }
+
+    void remove(int item) {
+        int i = pos[item];
+        int last = heap.back();
+        heap.pop_back();
+        pos[item] = -1;
+        if (last != item) {
+            place(i, last);
+            siftUp(i);
+            siftDown(pos[last]);
+        }
+    }
+
+    int pop() {
+        int item = heap[0];
+        remove(item);
+        return item;
+    }
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef __LOGGING_H
+#define __LOGGING_H
+
+#include <omnetpp.h>
+
+//
+// FAST_BUILD is defined by "make fast" (see makefrag), which also sets
+// COMPILETIME_LOGLEVEL to LOGLEVEL_OFF so that every EV line is compiled out.
+// GUI-only feedback such as bubble() goes through these macros to disappear as well.
+//
+#ifdef FAST_BUILD
+#define BUBBLE(text)  ((void)0)
+#else
+#define BUBBLE(text)  do { if (getEnvir()->isGUI()) bubble(text); } while (0)
+#endif
+
+/**
+ * Applies the "verbosity" parameter of a module to its runtime log level:
+ * 0 = no log, 1 = one line per event (EV), 2 = also details (EV_DETAIL and below).
+ * -1 (the default) leaves the level configured in omnetpp.ini (**.cmdenv-log-level) alone.
+ */
+inline void applyVerbosity(omnetpp::cComponent *component)
+{
+    int verbosity = component->par("verbosity");
+    if (verbosity < 0)
+        return;
+    component->setLogLevel(verbosity == 0 ? omnetpp::LOGLEVEL_OFF : verbosity == 1 ? omnetpp::LOGLEVEL_INFO : omnetpp::LOGLEVEL_TRACE);
+}
+
+#endif
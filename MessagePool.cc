@@ -0,0 +1,84 @@
+#include <MessagePool.h>
+
+using namespace omnetpp;
+
+Define_Module(MessagePool);
+
+
+MessagePool::MessagePool()
+{
+    hits = misses = released = 0;
+}
+
+MessagePool::~MessagePool()
+{
+    for (auto msg : freeList)
+        delete msg;
+}
+
+void MessagePool::initialize()
+{
+    int initialSize = par("initialSize");
+    freeList.reserve(initialSize);
+    for (int i = 0; i < initialSize; i++)
+        freeList.push_back(new PriorityMessage());
+
+    WATCH(hits);
+    WATCH(misses);
+    WATCH(released);
+}
+
+void MessagePool::handleMessage(cMessage *msg)
+{
+    throw cRuntimeError("MessagePool does not process messages, it is called by the Source and the Sink");
+}
+
+PriorityMessage *MessagePool::acquire()
+{
+    Enter_Method_Silent();
+
+    PriorityMessage *msg;
+    if (freeList.empty()) {
+        misses++;
+        msg = new PriorityMessage();
+    }
+    else {
+        hits++;
+        msg = freeList.back();
+        freeList.pop_back();
+    }
+    drop(msg);
+    return msg;
+}
+
+void MessagePool::release(PriorityMessage *msg)
+{
+    Enter_Method_Silent();
+
+    take(msg);
+    reset(msg);
+    freeList.push_back(msg);
+    released++;
+}
+
+// puts back the fields of PriorityMessage.msg to the values of a newly created message
+void MessagePool::reset(PriorityMessage *msg)
+{
+    msg->setName(nullptr);
+    msg->setJobId(0);
+    msg->setPriority(0);
+    msg->setWorkLeft(SIMTIME_ZERO);
+    msg->setQueueingTime(SIMTIME_ZERO);
+    msg->setWorkStart(SIMTIME_ZERO);
+    msg->setGenerationTime(SIMTIME_ZERO);
+    msg->setServiceDemand(SIMTIME_ZERO);
+    msg->setTimestamp(SIMTIME_ZERO);
+}
+
+void MessagePool::finish()
+{
+    recordScalar("poolHits", hits);
+    recordScalar("poolMisses", misses);
+    recordScalar("poolReleased", released);
+    recordScalar("poolFree", freeList.size());
+}
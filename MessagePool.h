@@ -0,0 +1,38 @@
+#ifndef __MESSAGEPOOL_H
+#define __MESSAGEPOOL_H
+
+#include <omnetpp.h>
+#include <PriorityMessage_m.h>
+
+/**
+ * Free-list of PriorityMessage objects: the Sink releases the messages it received
+ * instead of deleting them, and the Source acquires them instead of allocating new
+ * ones, so in steady state no job costs a heap allocation.
+ *
+ * Ownership follows the usual drop/take protocol: acquire() drops the message and the
+ * caller takes it, release() takes a message the caller has dropped.
+ */
+class MessagePool : public omnetpp::cSimpleModule
+{
+  private:
+    std::vector<PriorityMessage*> freeList;
+
+    long hits;   // acquire() served from the free list
+    long misses; // acquire() had to allocate
+    long released;
+
+  public:
+    MessagePool();
+    virtual ~MessagePool();
+
+    virtual PriorityMessage *acquire();
+    virtual void release(PriorityMessage *msg);
+
+  protected:
+    virtual void initialize() override;
+    virtual void handleMessage(omnetpp::cMessage *msg) override;
+    virtual void finish() override;
+    virtual void reset(PriorityMessage *msg);
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef __P2QUANTILE_H
+#define __P2QUANTILE_H
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Streaming estimate of one quantile with the P-square algorithm (Jain & Chlamtac, 1985):
+ * five markers whose heights are adjusted with a piecewise-parabolic formula as
+ * observations arrive. Constant memory and O(1) work per observation.
+ */
+class P2Quantile
+{
+  private:
+    double p;          // the quantile, in (0,1)
+    long count;
+    double q[5];       // marker heights
+    double n[5];       // actual marker positions
+    double np[5];      // desired marker positions
+    double dn[5];      // increments of the desired positions
+
+    double parabolic(int i, int d) const {
+        return q[i] + d / (n[i+1] - n[i-1]) * ((n[i] - n[i-1] + d) * (q[i+1] - q[i]) / (n[i+1] - n[i])
+                                             + (n[i+1] - n[i] - d) * (q[i] - q[i-1]) / (n[i] - n[i-1]));
+    }
+
+    double linear(int i, int d) const {
+        return q[i] + d * (q[i+d] - q[i]) / (n[i+d] - n[i]);
+    }
+
+  public:
+    P2Quantile(double p = 0.5) : p(p), count(0) {
+        dn[0] = 0; dn[1] = p / 2; dn[2] = p; dn[3] = (1 + p) / 2; dn[4] = 1;
+    }
+
+    double getQuantile() const { return p; }
+    long getCount() const { return count; }
+
+    void collect(double x) {
+        if (count < 5) {
+            q[count++] = x;
+            if (count == 5) {
+                std::sort(q, q + 5);
+                for (int i = 0; i < 5; i++)
+                    n[i] = i;
+                np[0] = 0; np[1] = 2 * p; np[2] = 4 * p; np[3] = 2 + 2 * p; np[4] = 4;
+            }
+            return;
+        }
+        count++;
+
+        // find the cell k the observation falls into, extending the extremes if needed
+        int k;
+        if (x < q[0]) { q[0] = x; k = 0; }
+        else if (x >= q[4]) { q[4] = x; k = 3; }
+        else { k = 0; while (x >= q[k+1]) k++; }
+
+        for (int i = k + 1; i < 5; i++)
+            n[i]++;
+        for (int i = 0; i < 5; i++)
+            np[i] += dn[i];
+
+        // move the three middle markers towards their desired position if they are off by one or more
+        for (int i = 1; i < 4; i++) {
+            double d = np[i] - n[i];
+            if ((d >= 1 && n[i+1] - n[i] > 1) || (d <= -1 && n[i-1] - n[i] < -1)) {
+                int sign = d > 0 ? 1 : -1;
+                double candidate = parabolic(i, sign);
+                q[i] = (q[i-1] < candidate && candidate < q[i+1]) ? candidate : linear(i, sign);
+                n[i] += sign;
+            }
+        }
+    }
+
+    // the current estimate, NaN without observations
+    double get() const {
+        if (count == 0)
+            return NAN;
+        if (count < 5) { // exact quantile of the few values seen so far
+            double sorted[5];
+            std::copy(q, q + count, sorted);
+            std::sort(sorted, sorted + count);
+            return sorted[std::min((long)(p * count), count - 1)];
+        }
+        return q[2];
+    }
+};
+
+#endif
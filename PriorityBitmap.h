@@ -0,0 +1,110 @@
+#ifndef __PRIORITYBITMAP_H
+#define __PRIORITYBITMAP_H
+
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * Multi-level bitmap of the non-empty priority classes.
+ *
+ * Level 0 has one bit per class, every upper level has one bit per non-zero
+ * word of the level below it, and the top level is a single 64-bit word.
+ * Marking a class as (non-)empty and finding the most important non-empty
+ * class (the lowest index, 0 is the highest priority) both touch one word
+ * per level, i.e. 1 word up to 64 classes, 2 up to 4096, 3 up to 262144.
+ */
+class PriorityBitmap
+{
+  private:
+    std::vector<std::vector<uint64_t>> levels; // levels[0] = classes, levels.back() = single summary word
+    int numClasses;
+
+    static int lowestBit(uint64_t word) {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanForward64(&idx, word);
+        return (int)idx;
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    static int highestBit(uint64_t word) {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanReverse64(&idx, word);
+        return (int)idx;
+#else
+        return 63 - __builtin_clzll(word);
+#endif
+    }
+
+  public:
+    PriorityBitmap(int numClasses = 0) { resize(numClasses); }
+
+    // drops every bit and resizes the bitmap to hold classes [0, numClasses)
+    void resize(int numClasses) {
+        this->numClasses = numClasses;
+        levels.clear();
+        int count = numClasses;
+        do {
+            count = (count + 63) / 64;
+            levels.push_back(std::vector<uint64_t>(count, 0));
+        } while (count > 1);
+    }
+
+    int getSize() const { return numClasses; }
+
+    bool isEmpty() const { return levels.back().empty() || levels.back()[0] == 0; }
+
+    bool test(int cls) const { return (levels[0][cls >> 6] >> (cls & 63)) & 1; }
+
+    // class cls became non-empty
+    void set(int cls) {
+        for (auto& level : levels) {
+            uint64_t& word = level[cls >> 6];
+            bool wasZero = (word == 0);
+            word |= (uint64_t)1 << (cls & 63);
+            if (!wasZero)
+                return; // upper levels already know about this word
+            cls >>= 6;
+        }
+    }
+
+    // class cls became empty
+    void clear(int cls) {
+        for (auto& level : levels) {
+            uint64_t& word = level[cls >> 6];
+            word &= ~((uint64_t)1 << (cls & 63));
+            if (word != 0)
+                return; // word still has other non-empty classes
+            cls >>= 6;
+        }
+    }
+
+    // returns the most important (lowest index) non-empty class, -1 if all are empty
+    int findFirst() const {
+        if (isEmpty())
+            return -1;
+        int idx = 0;
+        for (int l = (int)levels.size() - 1; l >= 0; l--)
+            idx = (idx << 6) + lowestBit(levels[l][idx]);
+        return idx;
+    }
+
+    // returns the least important (highest index) non-empty class, -1 if all are empty
+    int findLast() const {
+        if (isEmpty())
+            return -1;
+        int idx = 0;
+        for (int l = (int)levels.size() - 1; l >= 0; l--)
+            idx = (idx << 6) + highestBit(levels[l][idx]);
+        return idx;
+    }
+};
+
+#endif
@@ -181,10 +181,13 @@ Register_Class(PriorityMessage)
 
 PriorityMessage::PriorityMessage(const char *name, short kind) : ::omnetpp::cMessage(name,kind)
 {
+    this->jobId = 0;
     this->priority = 0;
     this->workLeft = 0;
     this->queueingTime = 0;
     this->workStart = 0;
+    this->generationTime = 0;
+    this->serviceDemand = 0;
 }
 
 PriorityMessage::PriorityMessage(const PriorityMessage& other) : ::omnetpp::cMessage(other)
@@ -206,28 +209,47 @@ PriorityMessage& PriorityMessage::operator=(const PriorityMessage& other)
 
 void PriorityMessage::copy(const PriorityMessage& other)
 {
+    this->jobId = other.jobId;
     this->priority = other.priority;
     this->workLeft = other.workLeft;
     this->queueingTime = other.queueingTime;
     this->workStart = other.workStart;
+    this->generationTime = other.generationTime;
+    this->serviceDemand = other.serviceDemand;
 }
 
 void PriorityMessage::parsimPack(omnetpp::cCommBuffer *b) const
 {
     ::omnetpp::cMessage::parsimPack(b);
+    doParsimPacking(b,this->jobId);
     doParsimPacking(b,this->priority);
     doParsimPacking(b,this->workLeft);
     doParsimPacking(b,this->queueingTime);
     doParsimPacking(b,this->workStart);
+    doParsimPacking(b,this->generationTime);
+    doParsimPacking(b,this->serviceDemand);
 }
 
 void PriorityMessage::parsimUnpack(omnetpp::cCommBuffer *b)
 {
     ::omnetpp::cMessage::parsimUnpack(b);
+    doParsimUnpacking(b,this->jobId);
     doParsimUnpacking(b,this->priority);
     doParsimUnpacking(b,this->workLeft);
     doParsimUnpacking(b,this->queueingTime);
     doParsimUnpacking(b,this->workStart);
+    doParsimUnpacking(b,this->generationTime);
+    doParsimUnpacking(b,this->serviceDemand);
+}
+
+int64_t PriorityMessage::getJobId() const
+{
+    return this->jobId;
+}
+
+void PriorityMessage::setJobId(int64_t jobId)
+{
+    this->jobId = jobId;
 }
 
 int PriorityMessage::getPriority() const
@@ -270,6 +292,26 @@ void PriorityMessage::setWorkStart(::omnetpp::simtime_t workStart)
     this->workStart = workStart;
 }
 
+::omnetpp::simtime_t PriorityMessage::getGenerationTime() const
+{
+    return this->generationTime;
+}
+
+void PriorityMessage::setGenerationTime(::omnetpp::simtime_t generationTime)
+{
+    this->generationTime = generationTime;
+}
+
+::omnetpp::simtime_t PriorityMessage::getServiceDemand() const
+{
+    return this->serviceDemand;
+}
+
+void PriorityMessage::setServiceDemand(::omnetpp::simtime_t serviceDemand)
+{
+    this->serviceDemand = serviceDemand;
+}
+
 class PriorityMessageDescriptor : public omnetpp::cClassDescriptor
 {
   private:
@@ -335,7 +377,7 @@ const char *PriorityMessageDescriptor::getProperty(const char *propertyname) con
 int PriorityMessageDescriptor::getFieldCount() const
 {
     omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    return basedesc ? 4+basedesc->getFieldCount() : 4;
+    return basedesc ? 7+basedesc->getFieldCount() : 7;
 }
 
 unsigned int PriorityMessageDescriptor::getFieldTypeFlags(int field) const
@@ -351,8 +393,11 @@ unsigned int PriorityMessageDescriptor::getFieldTypeFlags(int field) const
         FD_ISEDITABLE,
         FD_ISEDITABLE,
         FD_ISEDITABLE,
+        FD_ISEDITABLE,
+        FD_ISEDITABLE,
+        FD_ISEDITABLE,
     };
-    return (field>=0 && field<4) ? fieldTypeFlags[field] : 0;
+    return (field>=0 && field<7) ? fieldTypeFlags[field] : 0;
 }
 
 const char *PriorityMessageDescriptor::getFieldName(int field) const
@@ -364,22 +409,28 @@ const char *PriorityMessageDescriptor::getFieldName(int field) const
         field -= basedesc->getFieldCount();
     }
     static const char *fieldNames[] = {
+        "jobId",
         "priority",
         "workLeft",
         "queueingTime",
         "workStart",
+        "generationTime",
+        "serviceDemand",
     };
-    return (field>=0 && field<4) ? fieldNames[field] : nullptr;
+    return (field>=0 && field<7) ? fieldNames[field] : nullptr;
 }
 
 int PriorityMessageDescriptor::findField(const char *fieldName) const
 {
     omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
     int base = basedesc ? basedesc->getFieldCount() : 0;
-    if (fieldName[0]=='p' && strcmp(fieldName, "priority")==0) return base+0;
-    if (fieldName[0]=='w' && strcmp(fieldName, "workLeft")==0) return base+1;
-    if (fieldName[0]=='q' && strcmp(fieldName, "queueingTime")==0) return base+2;
-    if (fieldName[0]=='w' && strcmp(fieldName, "workStart")==0) return base+3;
+    if (fieldName[0]=='j' && strcmp(fieldName, "jobId")==0) return base+0;
+    if (fieldName[0]=='p' && strcmp(fieldName, "priority")==0) return base+1;
+    if (fieldName[0]=='w' && strcmp(fieldName, "workLeft")==0) return base+2;
+    if (fieldName[0]=='q' && strcmp(fieldName, "queueingTime")==0) return base+3;
+    if (fieldName[0]=='w' && strcmp(fieldName, "workStart")==0) return base+4;
+    if (fieldName[0]=='g' && strcmp(fieldName, "generationTime")==0) return base+5;
+    if (fieldName[0]=='s' && strcmp(fieldName, "serviceDemand")==0) return base+6;
     return basedesc ? basedesc->findField(fieldName) : -1;
 }
 
@@ -392,12 +443,15 @@ const char *PriorityMessageDescriptor::getFieldTypeString(int field) const
         field -= basedesc->getFieldCount();
     }
     static const char *fieldTypeStrings[] = {
+        "int64_t",
         "int",
         "simtime_t",
         "simtime_t",
         "simtime_t",
+        "simtime_t",
+        "simtime_t",
     };
-    return (field>=0 && field<4) ? fieldTypeStrings[field] : nullptr;
+    return (field>=0 && field<7) ? fieldTypeStrings[field] : nullptr;
 }
 
 const char **PriorityMessageDescriptor::getFieldPropertyNames(int field) const
@@ -464,10 +518,13 @@ std::string PriorityMessageDescriptor::getFieldValueAsString(void *object, int f
     }
     PriorityMessage *pp = (PriorityMessage *)object; (void)pp;
     switch (field) {
-        case 0: return long2string(pp->getPriority());
-        case 1: return simtime2string(pp->getWorkLeft());
-        case 2: return simtime2string(pp->getQueueingTime());
-        case 3: return simtime2string(pp->getWorkStart());
+        case 0: return int642string(pp->getJobId());
+        case 1: return long2string(pp->getPriority());
+        case 2: return simtime2string(pp->getWorkLeft());
+        case 3: return simtime2string(pp->getQueueingTime());
+        case 4: return simtime2string(pp->getWorkStart());
+        case 5: return simtime2string(pp->getGenerationTime());
+        case 6: return simtime2string(pp->getServiceDemand());
         default: return "";
     }
 }
@@ -482,10 +539,13 @@ bool PriorityMessageDescriptor::setFieldValueAsString(void *object, int field, i
     }
     PriorityMessage *pp = (PriorityMessage *)object; (void)pp;
     switch (field) {
-        case 0: pp->setPriority(string2long(value)); return true;
-        case 1: pp->setWorkLeft(string2simtime(value)); return true;
-        case 2: pp->setQueueingTime(string2simtime(value)); return true;
-        case 3: pp->setWorkStart(string2simtime(value)); return true;
+        case 0: pp->setJobId(string2int64(value)); return true;
+        case 1: pp->setPriority(string2long(value)); return true;
+        case 2: pp->setWorkLeft(string2simtime(value)); return true;
+        case 3: pp->setQueueingTime(string2simtime(value)); return true;
+        case 4: pp->setWorkStart(string2simtime(value)); return true;
+        case 5: pp->setGenerationTime(string2simtime(value)); return true;
+        case 6: pp->setServiceDemand(string2simtime(value)); return true;
         default: return false;
     }
 }
@@ -26,20 +26,26 @@
  * //
  * message PriorityMessage
  * {
+ *     int64_t jobId; // unique per run, the identity of the job (names are only set for the GUI and logging)
  *     int priority;
  *     simtime_t workLeft;
  *     simtime_t queueingTime;
  *     simtime_t workStart;
+ *     simtime_t generationTime; // set by the Source; pooled messages are reused, so their creation time is not the job's
+ *     simtime_t serviceDemand; // service time set by the Source (drawn at generation or from a trace), 0 to let the Queue draw it
  * }
  * </pre>
  */
 class PriorityMessage : public ::omnetpp::cMessage
 {
   protected:
+    int64_t jobId;
     int priority;
     ::omnetpp::simtime_t workLeft;
     ::omnetpp::simtime_t queueingTime;
     ::omnetpp::simtime_t workStart;
+    ::omnetpp::simtime_t generationTime;
+    ::omnetpp::simtime_t serviceDemand;
 
   private:
     void copy(const PriorityMessage& other);
@@ -58,6 +64,8 @@ class PriorityMessage : public ::omnetpp::cMessage
     virtual void parsimUnpack(omnetpp::cCommBuffer *b) override;
 
     // field getter/setter methods
+    virtual int64_t getJobId() const;
+    virtual void setJobId(int64_t jobId);
     virtual int getPriority() const;
     virtual void setPriority(int priority);
     virtual ::omnetpp::simtime_t getWorkLeft() const;
@@ -66,6 +74,10 @@ class PriorityMessage : public ::omnetpp::cMessage
     virtual void setQueueingTime(::omnetpp::simtime_t queueingTime);
     virtual ::omnetpp::simtime_t getWorkStart() const;
     virtual void setWorkStart(::omnetpp::simtime_t workStart);
+    virtual ::omnetpp::simtime_t getGenerationTime() const;
+    virtual void setGenerationTime(::omnetpp::simtime_t generationTime);
+    virtual ::omnetpp::simtime_t getServiceDemand() const;
+    virtual void setServiceDemand(::omnetpp::simtime_t serviceDemand);
 };
 
 inline void doParsimPacking(omnetpp::cCommBuffer *b, const PriorityMessage& obj) {obj.parsimPack(b);}
@@ -0,0 +1,198 @@
+#include <omnetpp.h>
+#include <Distribution.h>
+
+using namespace omnetpp;
+
+
+/**
+ * Closed-form results of the network for the configurations that are an M/G/1 priority
+ * queue: Poisson arrivals per class (exponential interArrivalTimes), one server, and a
+ * non-preemptive or preemptive-resume discipline (preemptive-restart only with
+ * exponential service times that the Queue draws anew at every restart, which is then
+ * equivalent to resume). Per class k, with
+ * sigma_k = rho_0 + ... + rho_k and R = sum of lambda_i E[S_i^2] / 2:
+ *
+ *   non-preemptive (Cobham):  W_k = R / ((1 - sigma_{k-1}) (1 - sigma_k))
+ *   preemptive-resume:        T_k = E[S_k] / (1 - sigma_{k-1}) + R_k / ((1 - sigma_{k-1}) (1 - sigma_k))
+ *                             with R_k summed over the classes 0..k only
+ *
+ * The results are recorded as scalars of this module named like the simulated ones
+ * (responseTime<k>:mean, queueingTime<k>:mean, qlen<k>:timeavg, busy0:timeavg), so that
+ * they sit next to them in the .sca file. The response time includes the delay of the
+ * connection from the Source to the Queue, as the Sink's does. With analyticOnly, the run
+ * ends before the first event.
+ */
+class PriorityModel : public cSimpleModule
+{
+  private:
+    bool valid;
+    std::string reason; // why the model does not apply, if !valid
+    std::vector<double> lambda, responseTimes, queueingTimes;
+    double linkDelay;
+
+  protected:
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    virtual void solve();
+};
+
+Define_Module(PriorityModel);
+
+
+void PriorityModel::initialize()
+{
+    solve();
+    if (valid)
+        EV << "M/G/1 priority model solved for " << lambda.size() << " classes" << endl;
+    else
+        EV << "No closed form for this configuration: " << reason << endl;
+
+    if (par("analyticOnly").boolValue()) {
+        if (!valid)
+            throw cRuntimeError("analyticOnly is set, but %s", reason.c_str());
+        cMessage *stop = new cMessage("analytic-only");
+        stop->setSchedulingPriority(-1); // before anything else at time 0
+        scheduleAt(simTime(), stop);
+    }
+}
+
+void PriorityModel::handleMessage(cMessage *msg)
+{
+    delete msg;
+    endSimulation();
+}
+
+void PriorityModel::solve()
+{
+    cModule *queue = getModuleByPath("^.queue");
+    std::vector<cModule*> gens; // the Sources, whose arrivals add up
+    cModule *first = getParentModule()->getSubmodule("gen", 0); // nullptr when numSources = 0
+    for (int s = 0, n = first ? first->getVectorSize() : 0; s < n; s++)
+        gens.push_back(getParentModule()->getSubmodule("gen", s));
+    valid = false;
+    if (gens.empty()) {
+        reason = "the network has no Sources";
+        return;
+    }
+    cModule *gen = gens[0];
+    for (auto g : gens) {
+        if (*g->par("traceFile").stringValue()) {
+            reason = "the arrivals are replayed from a trace";
+            return;
+        }
+    }
+    if (queue->par("numServers").intValue() != 1) {
+        reason = "the queue has more than one server";
+        return;
+    }
+    if (queue->par("capacity").intValue() >= 0 || *queue->par("classCapacities").stringValue()) {
+        reason = "the queue has a bounded buffer";
+        return;
+    }
+    if (queue->par("policy").stdstringValue() != "priority") {
+        reason = "the queue is not served by strict priority";
+        return;
+    }
+    if (*queue->par("agingThresholds").stringValue()) {
+        reason = "the queue promotes jobs by aging";
+        return;
+    }
+    bool preemptive = queue->par("preemptive");
+    bool resume = queue->par("resume");
+    int numPrio = gen->par("numPrio");
+    // the service demands drawn by the Sources, else those the Queue draws
+    bool demandAtSource = *gen->par("serviceTimes").stringValue();
+    std::vector<Distribution> serviceTimes = Distribution::parseList((demandAtSource ? gen : queue)->par("serviceTimes"));
+    if (serviceTimes.empty()) {
+        reason = "serviceTimes is empty";
+        return;
+    }
+
+    // service time moments per class; the Queue serves the classes beyond the listed ones with a random listed one
+    std::vector<double> es(numPrio), es2(numPrio);
+    double mixMean = 0, mixSecondMoment = 0;
+    for (auto& d : serviceTimes) {
+        mixMean += d.getMean() / serviceTimes.size();
+        mixSecondMoment += d.getSecondMoment() / serviceTimes.size();
+    }
+    bool exponentialService = true;
+    for (auto& d : serviceTimes)
+        exponentialService = exponentialService && d.getKind() == Distribution::EXPONENTIAL;
+    if (preemptive && !resume && !exponentialService) {
+        reason = "preemptive-restart has no closed form unless the service times are exponential";
+        return;
+    }
+    if (preemptive && !resume && demandAtSource) {
+        reason = "preemptive-restart repeats the service demand drawn by the Source, which has no closed form";
+        return;
+    }
+    lambda.assign(numPrio, 0);
+    for (auto g : gens) {
+        std::vector<Distribution> interArrivalTimes = Distribution::parseList(g->par("interArrivalTimes"));
+        if (interArrivalTimes.empty()) {
+            reason = "interArrivalTimes is empty";
+            return;
+        }
+        for (int i = 0; i < numPrio; i++) {
+            const Distribution& d = interArrivalTimes[i % interArrivalTimes.size()]; // as the Source does
+            if (d.getKind() != Distribution::EXPONENTIAL) {
+                reason = "the arrivals of class " + std::to_string(i) + " are not Poisson";
+                return;
+            }
+            lambda[i] += 1 / d.getMean(); // independent Poisson streams merge into one of the total rate
+        }
+    }
+    for (int i = 0; i < numPrio; i++) {
+        es[i] = i < (int)serviceTimes.size() ? serviceTimes[i].getMean() : mixMean;
+        es2[i] = i < (int)serviceTimes.size() ? serviceTimes[i].getSecondMoment() : mixSecondMoment;
+    }
+
+    double residual = 0; // R, over all the classes
+    for (int i = 0; i < numPrio; i++)
+        residual += lambda[i] * es2[i] / 2;
+
+    responseTimes.resize(numPrio);
+    queueingTimes.resize(numPrio);
+    double sigmaBefore = 0, residualUpTo = 0;
+    for (int k = 0; k < numPrio; k++) {
+        double sigma = sigmaBefore + lambda[k] * es[k];
+        residualUpTo += lambda[k] * es2[k] / 2;
+        if (sigma >= 1)
+            responseTimes[k] = INFINITY; // this class and the less important ones are unstable
+        else if (preemptive)
+            responseTimes[k] = es[k] / (1 - sigmaBefore) + residualUpTo / ((1 - sigmaBefore) * (1 - sigma));
+        else
+            responseTimes[k] = residual / ((1 - sigmaBefore) * (1 - sigma)) + es[k];
+        queueingTimes[k] = responseTimes[k] - es[k];
+        sigmaBefore = sigma;
+    }
+
+    cChannel *channel = gen->gate("out")->getChannel(); // the links of all the Sources are alike in Net
+    linkDelay = channel && channel->hasPar("delay") ? channel->par("delay").doubleValue() : 0;
+    valid = true;
+}
+
+void PriorityModel::finish()
+{
+    recordScalar("valid", valid);
+    if (!valid)
+        return;
+    int numPrio = lambda.size();
+    double totalLambda = 0, utilization = 0, responseTime = 0, queueingTime = 0;
+    for (int k = 0; k < numPrio; k++) {
+        double es = responseTimes[k] - queueingTimes[k];
+        std::string i = std::to_string(k);
+        recordScalar(("responseTime" + i + ":mean").c_str(), responseTimes[k] + linkDelay);
+        recordScalar(("queueingTime" + i + ":mean").c_str(), queueingTimes[k]);
+        recordScalar(("qlen" + i + ":timeavg").c_str(), lambda[k] * queueingTimes[k]); // Little's law
+        totalLambda += lambda[k];
+        utilization += lambda[k] * es;
+        responseTime += lambda[k] * responseTimes[k];
+        queueingTime += lambda[k] * queueingTimes[k];
+    }
+    recordScalar("responseTime:mean", responseTime / totalLambda + linkDelay);
+    recordScalar("queueingTime:mean", queueingTime / totalLambda);
+    recordScalar("qlen:timeavg", queueingTime);
+    recordScalar("busy0:timeavg", std::min(utilization, 1.0));
+}
@@ -0,0 +1,145 @@
+#ifndef __PROFILER_H
+#define __PROFILER_H
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <omnetpp.h>
+
+/**
+ * Built-in profiling of a module, enabled by its "profiling" parameter: the events it
+ * handles, the wall time of every branch of its handleMessage() as a histogram with
+ * power-of-two buckets, and the number of values emitted on the signals it is given.
+ * finish() writes them as scalars named profile:..., and one of the profilers of the run
+ * also records the events per second of the whole simulation on the network module.
+ *
+ * Disabled (the default), start() and stop() only test a bool: the clock is not read and
+ * nothing is subscribed to the signals, which keep the fast path of emit() without
+ * listeners. It can stay compiled in for production sweeps.
+ */
+class Profiler : public omnetpp::cListener
+{
+  private:
+    typedef std::chrono::steady_clock Clock;
+    enum { NUM_BUCKETS = 40 }; // bucket b holds the events of 2^b to 2^(b+1) ns, b = 0 also those under 1 ns
+
+    struct Branch {
+        std::string name;
+        long events;
+        int64_t wallTime; // ns
+        long buckets[NUM_BUCKETS];
+    };
+
+    omnetpp::cComponent *owner;
+    bool enabled;
+    std::vector<Branch> branches;
+    std::vector<omnetpp::simsignal_t> signals;
+    std::vector<long> emitCounts; // indexed by signal id, only the counted signals are non-zero
+    Clock::time_point initTime;
+
+    // the profiler that records the event rate of the simulation, the first one enabled in the run
+    static Profiler *&runOwner() { static Profiler *profiler = nullptr; return profiler; }
+
+    void count(omnetpp::simsignal_t signalID) { emitCounts[signalID]++; }
+
+  public:
+    Profiler() : owner(nullptr), enabled(false) {}
+
+    ~Profiler() {
+        for (auto signal : signals)
+            if (owner->isSubscribed(signal, this))
+                owner->unsubscribe(signal, this);
+        if (runOwner() == this)
+            runOwner() = nullptr;
+    }
+
+    // call from initialize(), with the names of the branches that stop() will be given the index of
+    void init(omnetpp::cComponent *component, const std::vector<std::string>& branchNames) {
+        owner = component;
+        enabled = component->par("profiling");
+        if (!enabled)
+            return;
+        for (auto& name : branchNames)
+            branches.push_back(Branch{name, 0, 0, {}});
+        initTime = Clock::now();
+        if (!runOwner())
+            runOwner() = this;
+    }
+
+    bool isEnabled() const { return enabled; }
+
+    // counts the values emitted on these signals of the owner
+    void countEmits(const std::vector<omnetpp::simsignal_t>& ids) {
+        if (!enabled)
+            return;
+        for (auto signal : ids) {
+            if (signal >= (int)emitCounts.size())
+                emitCounts.resize(signal + 1, 0);
+            signals.push_back(signal);
+            owner->subscribe(signal, this);
+        }
+    }
+
+    void countEmits(omnetpp::simsignal_t signal) { countEmits(std::vector<omnetpp::simsignal_t>(1, signal)); }
+
+    // at the beginning of handleMessage(), to be passed to stop() at the end of it
+    Clock::time_point start() const { return enabled ? Clock::now() : Clock::time_point(); }
+
+    void stop(int branch, Clock::time_point started) {
+        if (!enabled)
+            return;
+        int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count();
+        Branch& b = branches[branch];
+        b.events++;
+        b.wallTime += ns;
+        int bucket = 0;
+        while (bucket < NUM_BUCKETS - 1 && (ns >> (bucket + 1)) != 0)
+            bucket++;
+        b.buckets[bucket]++;
+    }
+
+    // call from finish()
+    void record() {
+        if (!enabled)
+            return;
+        double elapsed = std::chrono::duration<double>(Clock::now() - initTime).count();
+        long events = 0;
+        int64_t wallTime = 0;
+        for (auto& b : branches) {
+            std::string prefix = "profile:" + b.name + ":";
+            owner->recordScalar((prefix + "events").c_str(), b.events);
+            owner->recordScalar((prefix + "wallTime").c_str(), b.wallTime * 1e-9, "s");
+            owner->recordScalar((prefix + "meanWallTime").c_str(), b.events ? b.wallTime * 1e-9 / b.events : NAN, "s");
+            // one scalar per non-empty bucket, named after its upper bound
+            for (int i = 0; i < NUM_BUCKETS; i++)
+                if (b.buckets[i])
+                    owner->recordScalar((prefix + "under" + std::to_string(2LL << i) + "ns").c_str(), b.buckets[i]);
+            events += b.events;
+            wallTime += b.wallTime;
+        }
+        owner->recordScalar("profile:events", events);
+        owner->recordScalar("profile:wallTime", wallTime * 1e-9, "s");
+        owner->recordScalar("profile:share", elapsed > 0 ? wallTime * 1e-9 / elapsed : NAN); // of the wall time of the run
+        for (auto signal : signals)
+            owner->recordScalar(("profile:emits:" + std::string(omnetpp::cComponent::getSignalName(signal))).c_str(), emitCounts[signal]);
+
+        if (runOwner() == this) {
+            omnetpp::cModule *network = omnetpp::getSimulation()->getSystemModule();
+            network->recordScalar("profile:events", omnetpp::getSimulation()->getEventNumber());
+            network->recordScalar("profile:wallTime", elapsed, "s");
+            network->recordScalar("profile:eventsPerSecond", elapsed > 0 ? omnetpp::getSimulation()->getEventNumber() / elapsed : NAN);
+        }
+    }
+
+    virtual void receiveSignal(omnetpp::cComponent *source, omnetpp::simsignal_t signalID, bool b, omnetpp::cObject *details) override { count(signalID); }
+    virtual void receiveSignal(omnetpp::cComponent *source, omnetpp::simsignal_t signalID, long l, omnetpp::cObject *details) override { count(signalID); }
+    virtual void receiveSignal(omnetpp::cComponent *source, omnetpp::simsignal_t signalID, unsigned long l, omnetpp::cObject *details) override { count(signalID); }
+    virtual void receiveSignal(omnetpp::cComponent *source, omnetpp::simsignal_t signalID, double d, omnetpp::cObject *details) override { count(signalID); }
+    virtual void receiveSignal(omnetpp::cComponent *source, omnetpp::simsignal_t signalID, const omnetpp::SimTime& t, omnetpp::cObject *details) override { count(signalID); }
+    virtual void receiveSignal(omnetpp::cComponent *source, omnetpp::simsignal_t signalID, const char *s, omnetpp::cObject *details) override { count(signalID); }
+    virtual void receiveSignal(omnetpp::cComponent *source, omnetpp::simsignal_t signalID, omnetpp::cObject *obj, omnetpp::cObject *details) override { count(signalID); }
+};
+
+#endif
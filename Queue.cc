@@ -1,5 +1,16 @@
 #include <omnetpp.h>
 #include <PriorityMessage_m.h>
+#include <PriorityBitmap.h>
+#include <ClassFifos.h>
+#include <IndexedHeap.h>
+#include <FairQueueing.h>
+#include <WorkHeap.h>
+#include <TimingWheel.h>
+#include <Distribution.h>
+#include <ClassSignals.h>
+#include <MessagePool.h>
+#include <Profiler.h>
+#include <Logging.h>
 
 using namespace omnetpp;
 
@@ -7,39 +18,111 @@ using namespace omnetpp;
 class Queue : public cSimpleModule
 {
   protected:
-    cMessage *msgServiced;
-    cMessage *endServiceMsg;
+    struct Server {
+        PriorityMessage *msgServiced; // nullptr if the server is idle
+        int priority;                 // class the job is served as: its own, or the one aging promoted it to
+        cMessage *endServiceMsg;      // kind = index of the server
+        simtime_t serviceStart;       // of the current service period, for the work lost to a preemption
+        simtime_t workEnd;            // needed for preemptive resume
+    };
+    std::vector<Server> servers;
+    std::vector<int> idleServers; // stack of the idle servers
+    // busy servers by (priority, start of service) of their job: the top one is the preemption victim,
+    // the least important job and, among equals, the one that has been served for the shortest time;
+    // under SRPT by (0, end of service), the victim is the job with the most work left
+    IndexedHeap<std::pair<int, int64_t>> busyServers;
 
     int numPrio;
+    int numServers;
     bool isPreemptive;
     bool preemptiveResume;
-    simtime_t workEnd; // needed for preemptive resume
-    cMersenneTwister* rng; // random number generator
-    std::vector<double> serviceTimes;
-
-    cArray queues; //array of queues; so to avoid scanning all the queue every time, we thought that
-                   //splitting the queue in "sub-queues" based on priority will increase performance.
+    cRNG *rng; // service times, local RNG 0
+    std::vector<Distribution> serviceTimes; // per-class, parsed once (see Distribution.h)
+
+    ClassFifos<PriorityMessage*> queues; //one FIFO per priority; so to avoid scanning all the queue every time, we thought that
+                                         //splitting the queue in "sub-queues" based on priority will increase performance.
+    PriorityBitmap nonEmptyQueues; // one bit per non-empty sub-queue, so that getMsgToServe() does not scan them all
+    long totalQueueLength;         // sum of the sub-queue lengths, so that emitting qlen doesn't re-sum them
+
+    // Order in which the sub-queues are served: strict priority (nonEmptyQueues), or weighted fair
+    // queueing or deficit round robin over the per-class weights (FairQueueing.h). SJF and SRPT serve
+    // the job with the least work left whatever its class, from bySize instead of the sub-queues.
+    // All but strict priority need the size of every job when it enters the queue: the service
+    // demand the Source drew, or else one the Queue draws on arrival.
+    enum Policy { PRIORITY, WFQ, DRR, SJF, SRPT };
+    Policy policy;
+    bool isSizeBased; // SJF or SRPT
+    WfqScheduler wfq;
+    DrrScheduler drr;
+    WorkHeap<PriorityMessage*> bySize;
+
+    // Aging (strict priority only): a job that has waited agingThreshold[k] in sub-queue k moves to the
+    // tail of sub-queue k-1, keeping its own class for the statistics. The jobs of a sub-queue are in
+    // order of entry, so only the oldest one can be due: agingWheel holds the sub-queues whose oldest
+    // job is due in each slot of agingGranularity, and a tick at the end of every slot promotes the
+    // due jobs, without ever scanning the queued ones.
+    bool isAging;
+    std::vector<simtime_t> agingThreshold; // per class, 0 if its jobs are never promoted
+    ClassFifos<int64_t> classEntryTimes;   // raw time each queued job entered its sub-queue, in step with queues
+    TimingWheel agingWheel;
+    cMessage *agingMsg;                    // the tick, scheduled while agingWheel is not empty
+
+    // Qtenv view of the sub-queues, which are not cObjects: their lengths and the queued jobs as children
+    class QueueView : public cOwnedObject {
+        const Queue *queue;
+      public:
+        QueueView(const char *name, const Queue *queue) : cOwnedObject(name), queue(queue) {}
+        virtual std::string str() const override;
+        virtual void forEachChild(cVisitor *v) override;
+    };
+    QueueView queueView;
 
     simsignal_t qlenSignal;
-    simsignal_t busySignal;
+    std::vector<simsignal_t> qlenSignals; // per-class qlen<k>
+    std::vector<simsignal_t> busySignals; // per-server busy<k>
+    simsignal_t utilizationSignal;        // fraction of the servers that are busy
 
     // Global
     simsignal_t queueingTimeSignal;
 
     simsignal_t eServiceTimeSignal;
 
-    // Per-class
-    simsignal_t queueingTimeSignal0;
-    simsignal_t queueingTimeSignal1;
-    simsignal_t queueingTimeSignal2;
-    simsignal_t queueingTimeSignal3;
-    simsignal_t queueingTimeSignal4;
-
-    simsignal_t eServiceTimeSignal0;
-    simsignal_t eServiceTimeSignal1;
-    simsignal_t eServiceTimeSignal2;
-    simsignal_t eServiceTimeSignal3;
-    simsignal_t eServiceTimeSignal4;
+    // Per-class, indexed by priority
+    std::vector<simsignal_t> queueingTimeSignals;
+
+    std::vector<simsignal_t> eServiceTimeSignals;
+
+    // Preemptions, per class of the evicted job: preempted<k> (the work done before the eviction)
+    // and, in restart mode, wastedWork<k> (the same work, lost)
+    simsignal_t preemptedSignal;
+    std::vector<simsignal_t> preemptedSignals;
+    simsignal_t wastedWorkSignal;
+    std::vector<simsignal_t> wastedWorkSignals;
+
+    // Bounded buffer: a job that finds all the servers busy and the buffer full is dropped, or with
+    // PUSH_OUT takes the place of the newest job of a less important class; EARLY_DROP also drops
+    // arrivals at random as the buffer fills up. Jobs evicted by a preemption always go back in.
+    enum DropPolicy { TAIL_DROP, PUSH_OUT, EARLY_DROP };
+    DropPolicy dropPolicy;
+    long capacity;                   // total, -1 if unbounded
+    std::vector<long> classCapacity; // per class, -1 if unbounded
+    bool isBounded;
+    long earlyDropStart;             // total queue length from which EARLY_DROP drops at random
+    double earlyDropProbability;     // drop probability when the buffer is about to be full
+    cRNG *dropRng;                   // early drops, local RNG 1
+    MessagePool *pool;               // dropped jobs go back to it if the network has one
+
+    std::vector<long> arrivals;  // per class
+    std::vector<long> refused;   // per class, dropped on arrival
+    std::vector<long> pushedOut; // per class, dropped from the buffer to make room
+    simsignal_t droppedSignal;   // every dropped job, with the time it had waited in the buffer
+    std::vector<simsignal_t> droppedSignals;
+    simsignal_t promotedSignal;  // every promotion by aging, with the time the job had waited in the class it left
+    std::vector<simsignal_t> promotedSignals; // per class left
+
+    // profiling (Profiler.h), one branch per path through handleMessage()
+    enum { COMPLETION, DIRECT_SERVICE, ENQUEUE, PREEMPTION, DROP, AGING };
+    Profiler profiler;
 
   public:
     Queue();
@@ -48,45 +131,165 @@ class Queue : public cSimpleModule
   protected:
     virtual void initialize() override;
     virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    virtual void refreshDisplay() const override;
+    virtual void startService(int server, PriorityMessage *msg, int priority);
+    virtual PriorityMessage *endService(int server);
+    virtual void preempt(int server, PriorityMessage *msg);
+    virtual simtime_t getCompletionTime(PriorityMessage *msg);
+    virtual bool preempts(PriorityMessage *msg);
+    virtual std::pair<int, int64_t> getServerKey(const Server& server);
+    virtual void rescheduleEndService(Server& server);
     virtual int getMsgToServe();
+    virtual void insertInQueue(PriorityMessage *msg, int priority);
+    virtual PriorityMessage *popFromQueue(int priority);
+    virtual PriorityMessage *popNewestFromQueue(int priority);
+    virtual void queueShrunk(int priority);
+    virtual void watchOldest(int priority);
+    virtual void promote(int priority);
+    virtual bool admit(PriorityMessage *msg);
+    virtual void dropJob(PriorityMessage *msg, bool fromBuffer);
     virtual double getServiceTimeForPriority(int priority);
     virtual long getTotalQueueLength();
+    int getQueueLength(int priority) const;
 };
 
 Define_Module(Queue);
 
 
-Queue::Queue()
+Queue::Queue() : queueView("queues", this)
 {
-    msgServiced = endServiceMsg = nullptr;
+    agingMsg = nullptr;
 }
 
 Queue::~Queue()
 {
-    delete msgServiced;
-    cancelAndDelete(endServiceMsg);
+    for (auto& server : servers) {
+        delete server.msgServiced;
+        cancelAndDelete(server.endServiceMsg);
+    }
+    for (int i = 0; i < queues.getNumClasses(); i++)
+        while (!queues.isEmpty(i))
+            delete queues.pop(i);
+    while (!bySize.isEmpty())
+        delete bySize.pop();
+    cancelAndDelete(agingMsg);
 }
 
 void Queue::initialize()
 {
-    endServiceMsg = new cMessage("end-service");
+    applyVerbosity(this);
 
     isPreemptive = par("preemptive");
     preemptiveResume = par("resume");
     numPrio = par("numPrio"); //number of priority queues
+    numServers = par("numServers");
+    if (numServers < 1)
+        throw cRuntimeError("numServers must be at least 1, got %d", numServers);
+
+    servers.resize(numServers);
+    busyServers.resize(numServers);
+    for (int k = numServers - 1; k >= 0; k--) { // server 0 on top of the stack, taken first
+        servers[k].msgServiced = nullptr;
+        servers[k].endServiceMsg = new cMessage("end-service", k);
+        idleServers.push_back(k);
+    }
 
-    rng = new cMersenneTwister();
-    serviceTimes = cStringTokenizer(par("serviceTimes")).asDoubleVector();
-
-    for(int i = 0; i < numPrio; i++){
-        //creating #queues that equals the # of priorities
-        //NB the queues are ordered. The most important is queues[0] and than come the others
-       queues.add(new cQueue(std::to_string(i).c_str())); //creating queue with name = priority
-       workEnd = SIMTIME_ZERO;
-   }
+    rng = getRNG(0);
+    serviceTimes = Distribution::parseList(par("serviceTimes"));
+
+    capacity = par("capacity");
+    std::vector<int> capacities = cStringTokenizer(par("classCapacities")).asIntVector();
+    classCapacity.assign(numPrio, -1);
+    for (int i = 0; i < numPrio && !capacities.empty(); i++)
+        classCapacity[i] = capacities[i % capacities.size()]; // reused cyclically, like the inter-arrival times
+    isBounded = capacity >= 0;
+    for (long c : classCapacity)
+        isBounded = isBounded || c >= 0;
+    std::string drops = par("dropPolicy").stdstringValue();
+    if (drops == "tail")
+        dropPolicy = TAIL_DROP;
+    else if (drops == "pushOut")
+        dropPolicy = PUSH_OUT;
+    else if (drops == "early")
+        dropPolicy = EARLY_DROP;
+    else
+        throw cRuntimeError("Unknown dropPolicy \"%s\", expected tail, pushOut or early", drops.c_str());
+    if (dropPolicy == EARLY_DROP && capacity < 1)
+        throw cRuntimeError("dropPolicy \"early\" needs a total capacity of at least 1");
+    earlyDropStart = (long)ceil(par("earlyDropThreshold").doubleValue() * capacity);
+    earlyDropProbability = par("earlyDropProbability");
+    dropRng = getRNG(1);
+    pool = check_and_cast_nullable<MessagePool*>(getModuleByPath("^.pool"));
+    arrivals.assign(numPrio, 0);
+    refused.assign(numPrio, 0);
+    pushedOut.assign(numPrio, 0);
+
+    //creating #queues that equals the # of priorities
+    //NB the queues are ordered. The most important is queues[0] and than come the others
+    queues.resize(numPrio);
+    nonEmptyQueues.resize(numPrio);
+    totalQueueLength = 0;
+
+    std::string order = par("policy").stdstringValue();
+    if (order == "priority")
+        policy = PRIORITY;
+    else if (order == "wfq")
+        policy = WFQ;
+    else if (order == "drr")
+        policy = DRR;
+    else if (order == "sjf")
+        policy = SJF;
+    else if (order == "srpt")
+        policy = SRPT;
+    else
+        throw cRuntimeError("Unknown policy \"%s\", expected priority, wfq, drr, sjf or srpt", order.c_str());
+    isSizeBased = policy == SJF || policy == SRPT;
+    if (policy == SRPT)
+        isPreemptive = preemptiveResume = true; // SRPT preempts by definition, and keeps the work done
+    else if (policy != PRIORITY && isPreemptive)
+        throw cRuntimeError("policy \"%s\" cannot preempt, set preemptive = false", order.c_str());
+    if (isSizeBased && dropPolicy == PUSH_OUT)
+        throw cRuntimeError("dropPolicy \"pushOut\" needs the sub-queues of the classes, which policy \"%s\" does not use", order.c_str());
+    std::vector<double> weightList = cStringTokenizer(par("weights")).asDoubleVector();
+    if (weightList.empty())
+        throw cRuntimeError("weights is empty");
+    std::vector<double> weights(numPrio);
+    for (int i = 0; i < numPrio; i++) {
+        weights[i] = weightList[i % weightList.size()]; // reused cyclically, like the inter-arrival times
+        if (weights[i] <= 0)
+            throw cRuntimeError("The weight of class %d must be positive, got %g", i, weights[i]);
+    }
+    double quantum = par("quantum");
+    if (policy == DRR && quantum <= 0)
+        throw cRuntimeError("quantum must be positive, got %g", quantum);
+    wfq.resize(policy == WFQ ? weights : std::vector<double>());
+    drr.resize(policy == DRR ? weights : std::vector<double>(), quantum);
+    bySize.resize(isSizeBased ? numPrio : 0);
+
+    std::vector<double> thresholds = cStringTokenizer(par("agingThresholds")).asDoubleVector();
+    agingThreshold.assign(numPrio, SIMTIME_ZERO);
+    simtime_t maxThreshold = SIMTIME_ZERO;
+    for (int i = 1; i < numPrio && !thresholds.empty(); i++) { // class 0 has nowhere to go
+        agingThreshold[i] = std::max(0.0, thresholds[i % thresholds.size()]); // reused cyclically, like the inter-arrival times
+        maxThreshold = std::max(maxThreshold, agingThreshold[i]);
+    }
+    isAging = maxThreshold > SIMTIME_ZERO;
+    if (isAging && policy != PRIORITY)
+        throw cRuntimeError("agingThresholds needs policy \"priority\"");
+    simtime_t agingGranularity = par("agingGranularity").doubleValue();
+    if (isAging && agingGranularity <= SIMTIME_ZERO)
+        throw cRuntimeError("agingGranularity must be positive");
+    classEntryTimes.resize(isAging ? numPrio : 0);
+    if (isAging) {
+        agingWheel.resize(agingGranularity.raw(), maxThreshold.raw());
+        agingMsg = new cMessage("aging");
+    }
 
     qlenSignal = registerSignal("qlen");
-    busySignal = registerSignal("busy");
+    qlenSignals = registerClassSignals(this, "qlen", numPrio);
+    busySignals = registerClassSignals(this, "busy", numServers);
+    utilizationSignal = registerSignal("utilization");
 
     // Global
     queueingTimeSignal = registerSignal("queueingTime");
@@ -94,29 +297,56 @@ void Queue::initialize()
     eServiceTimeSignal = registerSignal("eServiceTime");
 
     // Per-class
-    queueingTimeSignal0 = registerSignal("queueingTime0");
-    queueingTimeSignal1 = registerSignal("queueingTime1");
-    queueingTimeSignal2 = registerSignal("queueingTime2");
-    queueingTimeSignal3 = registerSignal("queueingTime3");
-    queueingTimeSignal4 = registerSignal("queueingTime4");
-
-    eServiceTimeSignal0 = registerSignal("eServiceTime0");
-    eServiceTimeSignal1 = registerSignal("eServiceTime1");
-    eServiceTimeSignal2 = registerSignal("eServiceTime2");
-    eServiceTimeSignal3 = registerSignal("eServiceTime3");
-    eServiceTimeSignal4 = registerSignal("eServiceTime4");
+    queueingTimeSignals = registerClassSignals(this, "queueingTime", numPrio);
+
+    eServiceTimeSignals = registerClassSignals(this, "eServiceTime", numPrio);
+
+    preemptedSignal = registerSignal("preempted");
+    preemptedSignals = registerClassSignals(this, "preempted", numPrio);
+    wastedWorkSignal = registerSignal("wastedWork");
+    wastedWorkSignals = registerClassSignals(this, "wastedWork", numPrio);
+    droppedSignal = registerSignal("dropped");
+    droppedSignals = registerClassSignals(this, "dropped", numPrio);
+    promotedSignal = registerSignal("promoted");
+    promotedSignals = registerClassSignals(this, "promoted", numPrio);
+
+    profiler.init(this, {"completion", "directService", "enqueue", "preemption", "drop", "aging"});
+    profiler.countEmits({qlenSignal, utilizationSignal, queueingTimeSignal, eServiceTimeSignal, preemptedSignal, wastedWorkSignal, droppedSignal, promotedSignal});
+    profiler.countEmits(qlenSignals);
+    profiler.countEmits(busySignals);
+    profiler.countEmits(queueingTimeSignals);
+    profiler.countEmits(eServiceTimeSignals);
+    profiler.countEmits(preemptedSignals);
+    profiler.countEmits(wastedWorkSignals);
+    profiler.countEmits(droppedSignals);
+    profiler.countEmits(promotedSignals);
 
     emit(qlenSignal, getTotalQueueLength());
-    emit(busySignal, false);
+    for (int i = 0; i < numPrio; i++)
+        emit(qlenSignals[i], (long)getQueueLength(i));
+    for (int k = 0; k < numServers; k++)
+        emit(busySignals[k], false);
+    emit(utilizationSignal, 0.0);
 }
 
 void Queue::handleMessage(cMessage *msg)
 {
+    auto started = profiler.start();
+    int branch;
 
-    if (msg == endServiceMsg) { // Self-message arrived
+    if (msg == agingMsg) { // Aging tick: promote the jobs that have waited long enough in their sub-queue
+
+        branch = AGING;
+        agingWheel.advance(simTime().raw(), [this](int k) { promote(k); });
+        if (!agingWheel.isEmpty() && !agingMsg->isScheduled())
+            scheduleAt(SimTime::fromRaw(agingWheel.getNextTick()), agingMsg);
+    }
+    else if (msg->isSelfMessage()) { // Self-message arrived: end of service on the server in its kind
 
-        EV << "Completed service of " << msgServiced->getName() << endl;
-        auto prioMsg = (PriorityMessage*)msgServiced;
+        branch = COMPLETION;
+        int k = msg->getKind();
+        auto prioMsg = endService(k);
+        EV << "Completed service of " << prioMsg->getName() << " on server " << k << endl;
         auto qTime = prioMsg->getQueueingTime();
         auto esTime = simTime() - prioMsg->getWorkStart();
 
@@ -125,159 +355,387 @@ void Queue::handleMessage(cMessage *msg)
         emit(eServiceTimeSignal, esTime);
 
         // Per-class
-        switch (prioMsg->getPriority()){
-            case 0: emit(queueingTimeSignal0, qTime); emit(eServiceTimeSignal0, esTime); break;
-            case 1: emit(queueingTimeSignal1, qTime); emit(eServiceTimeSignal1, esTime); break;
-            case 2: emit(queueingTimeSignal2, qTime); emit(eServiceTimeSignal2, esTime); break;
-            case 3: emit(queueingTimeSignal3, qTime); emit(eServiceTimeSignal3, esTime); break;
-            case 4: emit(queueingTimeSignal4, qTime); emit(eServiceTimeSignal4, esTime); break;
-            default: break;
-        }
+        emit(queueingTimeSignals[prioMsg->getPriority()], qTime);
+        emit(eServiceTimeSignals[prioMsg->getPriority()], esTime);
 
-        send(msgServiced, "out");
+        send(prioMsg, "out");
 
-        if (getMsgToServe() == -1) { // Empty queue, server goes in IDLE
+        int notEmpty = getMsgToServe();
+        if (notEmpty == -1) { // Empty queue, server goes in IDLE
 
-            EV << "Empty queue, server goes IDLE" <<endl;
-            msgServiced = nullptr;
-            emit(busySignal, false);
+            EV << "Empty queue, server " << k << " goes IDLE" <<endl;
+            idleServers.push_back(k);
+            emit(busySignals[k], false);
+            emit(utilizationSignal, (double)busyServers.size() / numServers);
 
         }
 
         else { // Queue contains users
 
-            int notEmpty = 0;
-            if((notEmpty = getMsgToServe()) != -1){ //queue is not empty!
-                cQueue *queue = check_and_cast<cQueue*>(queues.get(notEmpty)); //taking the most important queue that is not empty
+            PriorityMessage *m = popFromQueue(notEmpty); //taking the most important queue that is not empty, emits the new length
+
+            if(m->getTimestamp() != SIMTIME_ZERO) // If the user has ever been in a queue
+                m->setQueueingTime(m->getQueueingTime() + (simTime() - m->getTimestamp())); // We increase the total queueing time of the message (so far)
 
-                PriorityMessage *m = (PriorityMessage*)(queue->pop());
-                emit(qlenSignal, getTotalQueueLength()); //Queue length changed, emit new length!
+            if(m->getWorkStart() == SIMTIME_ZERO) // If the user has never been in service
+                m->setWorkStart(simTime()); // We set it to the present, this will not be modified anymore until the service for this message is completed
 
-                if(m->getTimestamp() != SIMTIME_ZERO) // If the user has ever been in a queue
-                    m->setQueueingTime(m->getQueueingTime() + (simTime() - m->getTimestamp())); // We increase the total queueing time of the message (so far)
+            startService(k, m, notEmpty); //serving the message
+        }
+    }
+    else { // Data msg has arrived
 
-                if(m->getWorkStart() == SIMTIME_ZERO) // If the user has never been in service
-                    m->setWorkStart(simTime()); // We set it to the present, this will not be modified anymore until the service for this message is completed
+        PriorityMessage *arrivedMsg = check_and_cast<PriorityMessage*>(msg);
+        if (arrivedMsg->getPriority() < 0 || arrivedMsg->getPriority() >= numPrio)
+            throw cRuntimeError("Received a message with priority %d but numPrio is %d", arrivedMsg->getPriority(), numPrio);
 
-                msgServiced = m; //serving the message
+        //Setting arrival timestamp as msg field
+        arrivedMsg->setTimestamp();
+        arrivals[arrivedMsg->getPriority()]++;
+        if (policy != PRIORITY && arrivedMsg->getServiceDemand() == SIMTIME_ZERO)
+            arrivedMsg->setServiceDemand(getServiceTimeForPriority(arrivedMsg->getPriority())); // the job size the fair policies go by
+
+        if (!idleServers.empty()) { //A server is IDLE ==> No queue ==> Direct service
+
+            branch = DIRECT_SERVICE;
+            int k = idleServers.back();
+            idleServers.pop_back();
+            arrivedMsg->setWorkStart(simTime());
+            arrivedMsg->setQueueingTime(SIMTIME_ZERO);
+            startService(k, arrivedMsg, arrivedMsg->getPriority());
+            emit(busySignals[k], true);
+            emit(utilizationSignal, (double)busyServers.size() / numServers);
+        }
+        else if (isPreemptive && preempts(arrivedMsg)) {
+            //if there's someone with less priority (or, with SRPT, more work left) in service, kick it away
 
-                EV << "Starting service of " << msgServiced->getName() << endl;
-                simtime_t serviceTime = getServiceTimeForPriority(m->getPriority());
-                EV << "with service time of " << serviceTime.str() << "s" << endl;
+            branch = PREEMPTION;
+            preempt(busyServers.top(), arrivedMsg);
+            arrivedMsg->setWorkStart(simTime());
+        }
+        else if (isBounded && !admit(arrivedMsg)) { //All the servers BUSY and no room in the buffer ==> Drop
 
-                auto time = SIMTIME_ZERO;
-                if (isPreemptive && preemptiveResume && m->getWorkLeft() > 0) time = simTime() + m->getWorkLeft();
-                else time = simTime() + serviceTime;
+            branch = DROP;
+            dropJob(arrivedMsg, false);
+        }
+        else { //All the servers BUSY ==> Queuing
 
-                workEnd = time;
-                scheduleAt(time, endServiceMsg);
+            branch = ENQUEUE;
+            EV << "Queuing " << arrivedMsg->getName() << endl;
 
-                emit(busySignal, true);
-            }
+            insertInQueue(arrivedMsg, arrivedMsg->getPriority());
+            arrivedMsg->setTimestamp(simTime()); // We set the timestamp to when the message arrived in the queue
+       }
+    }
+
+    profiler.stop(branch, started);
+}// end of handleMessage
+
+void Queue::finish()
+{
+    profiler.record();
+
+    // fraction of the arrivals of each class dropped on arrival (blocking) and dropped at all (loss)
+    if (isBounded) {
+        long totalArrivals = 0, totalRefused = 0, totalDropped = 0;
+        for (int i = 0; i < numPrio; i++) {
+            recordScalar(("blockingProbability" + std::to_string(i)).c_str(), arrivals[i] ? (double)refused[i] / arrivals[i] : NAN);
+            recordScalar(("lossProbability" + std::to_string(i)).c_str(), arrivals[i] ? (double)(refused[i] + pushedOut[i]) / arrivals[i] : NAN);
+            totalArrivals += arrivals[i];
+            totalRefused += refused[i];
+            totalDropped += refused[i] + pushedOut[i];
         }
+        recordScalar("blockingProbability", totalArrivals ? (double)totalRefused / totalArrivals : NAN);
+        recordScalar("lossProbability", totalArrivals ? (double)totalDropped / totalArrivals : NAN);
     }
-    else { // Data msg has arrived
-        if(isPreemptive){ //check if the server is preemptive
+}
 
-            PriorityMessage* msgInService = (PriorityMessage*)msgServiced;
-            PriorityMessage* arrivedMsg = (PriorityMessage*)msg;
+// GUI only: the queue length under the icon
+void Queue::refreshDisplay() const
+{
+    char text[32];
+    sprintf(text, "q: %ld", totalQueueLength);
+    getDisplayString().setTagArg("t", 0, text);
+}
 
-            if(msgServiced && msgInService->getPriority() > arrivedMsg->getPriority()){//NB look at the condition ">".
-                //if there's someone with less priority, kick him away
+// puts msg in service on server k, that must be free, as a job of the given class; the caller emits busy<k>
+// and utilization if the server was idle
+void Queue::startService(int k, PriorityMessage *msg, int priority){
+    Server& server = servers[k];
+    server.msgServiced = msg;
+    server.priority = priority;
+
+    EV << "Starting service of " << msg->getName() << " on server " << k << endl;
+    server.serviceStart = simTime();
+    server.workEnd = getCompletionTime(msg);
+    scheduleAt(server.workEnd, server.endServiceMsg);
+    busyServers.push(k, getServerKey(server));
+}
 
-                ((cQueue*)queues.get(msgInService->getPriority()))->insert(msgInService); //putting the msg in service away
-                msgInService->setTimestamp(simTime()); // We set the timestamp to the moment the message was put back in the queue
-                bubble("Preemption occurred!");
-                EV << "Message " << msgServiced->getName() << " was thrown out because of preemption" << endl;
-                emit(qlenSignal, getTotalQueueLength());
-                EV << "Message " << msgServiced->getName() << " is back in queue" << endl;
-                cancelEvent(endServiceMsg);
+// replaces the job in service on server k with msg: the evicted job goes back to its queue with
+// the work it has left (resume) or loses the work done (restart); the end of service is moved and
+// the server re-keyed in place, rather than ending one service and starting another
+void Queue::preempt(int k, PriorityMessage *msg){
+    Server& server = servers[k];
+    PriorityMessage *msgInService = server.msgServiced;
+    int priority = msgInService->getPriority();
+    simtime_t workDone = simTime() - server.serviceStart;
+    if(preemptiveResume)
+        msgInService->setWorkLeft(server.workEnd - simTime()); // if we have to resume later, we save the work time that's already been done
+
+    insertInQueue(msgInService, server.priority); //putting the msg in service away, back in the class it was served as
+    msgInService->setTimestamp(simTime()); // We set the timestamp to the moment the message was put back in the queue
+    BUBBLE("Preemption occurred!");
+    EV << "Message " << msgInService->getName() << " was thrown out of server " << k << " because of preemption" << endl;
+    EV << "Message " << msgInService->getName() << " is back in queue" << endl;
+
+    emit(preemptedSignal, workDone);
+    emit(preemptedSignals[priority], workDone);
+    if(preemptiveResume){
+        EV_DETAIL << "Message " << msgInService->getName() << " has " << msgInService->getWorkLeft() << " work time left" << endl;
+    }
+    else {
+        emit(wastedWorkSignal, workDone);
+        emit(wastedWorkSignals[priority], workDone);
+    }
 
-                if(preemptiveResume){
-                    msgInService->setWorkLeft(workEnd - simTime()); // if we have to resume later, we save the work time that's already been done
-                    EV << "Message " << msgInService->getName() << " has " << msgInService->getWorkLeft() << " work time left" << endl;
-                }
+    server.msgServiced = msg;
+    server.priority = msg->getPriority();
+    EV << "Starting service of " << msg->getName() << " on server " << k << endl;
+    server.serviceStart = simTime();
+    server.workEnd = getCompletionTime(msg);
+    rescheduleEndService(server);
+    busyServers.update(k, getServerKey(server));
+}
 
-                msgServiced = arrivedMsg;
+// whether msg takes the server of the job at the top of busyServers: one of a less important class
+// (NB the condition ">"), or under SRPT one with more work left than msg needs
+bool Queue::preempts(PriorityMessage *msg){
+    int k = busyServers.top();
+    if (policy == SRPT)
+        return servers[k].workEnd - simTime() > msg->getServiceDemand();
+    return busyServers.getKey(k).first > msg->getPriority();
+}
 
-                EV << "Starting service of " << msgServiced->getName() << endl;
-                simtime_t serviceTime = getServiceTimeForPriority(arrivedMsg->getPriority());
-                EV << "with service time of " << serviceTime.str() << "s" << endl;
+// key of a busy server in busyServers, once its service has started
+std::pair<int, int64_t> Queue::getServerKey(const Server& server){
+    if (policy == SRPT)
+        return std::make_pair(0, server.workEnd.raw());
+    return std::make_pair(server.priority, server.serviceStart.raw());
+}
 
-                auto time = SIMTIME_ZERO;
-                if (isPreemptive && preemptiveResume && arrivedMsg->getWorkLeft() > 0) time = simTime() + arrivedMsg->getWorkLeft();
-                else time = simTime() + serviceTime;
+// end of the service of msg if it starts now: its remaining work if it is resuming, else a new service time
+simtime_t Queue::getCompletionTime(PriorityMessage *msg){
+    if (isPreemptive && preemptiveResume && msg->getWorkLeft() > 0)
+        return simTime() + msg->getWorkLeft(); // nothing to draw, the work left is known
 
-                workEnd = time;
-                scheduleAt(time, endServiceMsg);
-                arrivedMsg->setWorkStart(simTime());
-            }
+    simtime_t serviceTime = msg->getServiceDemand() > SIMTIME_ZERO ? msg->getServiceDemand() : getServiceTimeForPriority(msg->getPriority());
+    EV_DETAIL << "with service time of " << serviceTime.str() << "s" << endl;
+    return simTime() + serviceTime;
+}
 
-        }//end of if(isPreemptive)
+// moves the pending end of service of the server to its workEnd, in one FES operation where the kernel has one
+void Queue::rescheduleEndService(Server& server){
+#if OMNETPP_VERSION >= 0x0600
+    rescheduleAt(server.workEnd, server.endServiceMsg);
+#else
+    cancelEvent(server.endServiceMsg);
+    scheduleAt(server.workEnd, server.endServiceMsg);
+#endif
+}
 
-        //Setting arrival timestamp as msg field
-        msg->setTimestamp();
+// takes the message off server k, whose end of service must not be scheduled anymore; the server stays busy
+// until the caller starts another service on it or marks it idle
+PriorityMessage *Queue::endService(int k){
+    Server& server = servers[k];
+    PriorityMessage *msg = server.msgServiced;
+    server.msgServiced = nullptr;
+    busyServers.remove(k);
+    return msg;
+}
 
-        if (!msgServiced) { //No message in service (server IDLE) ==> No queue ==> Direct service
+int Queue::getMsgToServe(){
+    //strict priority: the bitmap knows which sub-queues are not empty, the lowest set bit is the most important one (priority 0 first)
+    //the fair policies ask their scheduler; if they are all empty, return -1
+    int i;
+    if (isSizeBased)
+        i = bySize.isEmpty() ? -1 : bySize.peekClass(); // the class of the job with the least work left, which popFromQueue() takes
+    else
+        i = policy == WFQ ? wfq.next() : policy == DRR ? drr.next() : nonEmptyQueues.findFirst();
+    ASSERT(i == -1 || getQueueLength(i) > 0);
+    return i;
+}
+
+double Queue::getServiceTimeForPriority(int priority){
+    if(priority >= 0 && priority < numPrio && serviceTimes.size() > 0){
+        if (priority <= (serviceTimes.size() - 1)) return serviceTimes[priority].draw(rng); // if the serviceTimes array has enough values, return the correct one
+        else return serviceTimes[rng->intRand(serviceTimes.size())].draw(rng); // otherwise just return a random time out of all the available ones
+    }
 
-            PriorityMessage *m = check_and_cast<PriorityMessage*>(msg);
-            msgServiced = m;
+    return 0;
+}
+
+// puts msg at the tail of the sub-queue of the given class: its own, or the one aging promoted it to
+void Queue::insertInQueue(PriorityMessage *msg, int priority){
+    totalQueueLength++;
+    if (isSizeBased) {
+        simtime_t work = msg->getWorkLeft() > SIMTIME_ZERO ? msg->getWorkLeft() : msg->getServiceDemand();
+        bySize.push(priority, work.raw(), msg);
+        emit(qlenSignal, totalQueueLength);
+        emit(qlenSignals[priority], (long)bySize.getLength(priority));
+        return;
+    }
+    queues.push(priority, msg);
+    if (isAging)
+        classEntryTimes.push(priority, simTime().raw());
+    if (queues.getLength(priority) == 1) {
+        nonEmptyQueues.set(priority);
+        watchOldest(priority);
+    }
+    if (policy == WFQ)
+        wfq.push(priority, msg->getServiceDemand().dbl());
+    else if (policy == DRR)
+        drr.push(priority, msg->getServiceDemand().dbl());
+
+    //Queue length changed, emit new length!
+    emit(qlenSignal, totalQueueLength);
+    emit(qlenSignals[priority], (long)queues.getLength(priority));
+}
 
-            EV << "Starting service of " << msgServiced->getName() << endl;
-            simtime_t serviceTime = getServiceTimeForPriority(m->getPriority());
+PriorityMessage *Queue::popFromQueue(int priority){
+    if (isSizeBased) { // the job with the least work left, of the class getMsgToServe() returned
+        PriorityMessage *msg = bySize.pop();
+        queueShrunk(priority);
+        return msg;
+    }
+    PriorityMessage *msg = queues.pop(priority);
+    if (isAging) {
+        classEntryTimes.pop(priority);
+        watchOldest(priority);
+    }
+    if (policy == WFQ)
+        wfq.pop(priority);
+    else if (policy == DRR)
+        drr.pop(priority);
+    queueShrunk(priority);
+    return msg;
+}
 
-            auto time = SIMTIME_ZERO;
-            if (isPreemptive && preemptiveResume && m->getWorkLeft() > 0) time = simTime() + m->getWorkLeft();
-            else time = simTime() + serviceTime;
+// the job of the class that entered the queue last, the one pushed out to make room
+PriorityMessage *Queue::popNewestFromQueue(int priority){
+    PriorityMessage *msg = queues.popBack(priority);
+    if (isAging)
+        classEntryTimes.popBack(priority);
+    if (policy == WFQ)
+        wfq.popBack(priority);
+    else if (policy == DRR)
+        drr.popBack(priority);
+    queueShrunk(priority);
+    return msg;
+}
 
-            workEnd = time;
-            scheduleAt(time, endServiceMsg);
-            m->setWorkStart(simTime());
-            m->setQueueingTime(SIMTIME_ZERO);
+void Queue::queueShrunk(int priority){
+    if (!isSizeBased && queues.isEmpty(priority))
+        nonEmptyQueues.clear(priority);
+    totalQueueLength--;
 
-            emit(busySignal, true);
-        }
-        else if(strcmp(msgServiced->getName(), msg->getName()) != 0){  //if needed for preemption
-            //Message in service (server BUSY) ==> Queuing
+    //Queue length changed, emit new length!
+    emit(qlenSignal, totalQueueLength);
+    emit(qlenSignals[priority], (long)getQueueLength(priority));
+}
 
-            EV << "Queuing " << msg->getName() << endl;
+// the oldest job of the sub-queue changed: puts the time it is due for promotion on the wheel
+void Queue::watchOldest(int priority){
+    if (!isAging || agingThreshold[priority] == SIMTIME_ZERO || queues.isEmpty(priority))
+        return;
+    agingWheel.add(simTime().raw(), classEntryTimes.get(priority, 0) + agingThreshold[priority].raw(), priority);
+    if (!agingMsg->isScheduled())
+        scheduleAt(SimTime::fromRaw(agingWheel.getNextTick()), agingMsg);
+}
 
-            PriorityMessage* prioMsg = (PriorityMessage*)msg;
-            ((cQueue*)(queues.get(prioMsg->getPriority())))->insert(prioMsg);
-            emit(qlenSignal, getTotalQueueLength());
-            prioMsg->setTimestamp(simTime()); // We set the timestamp to when the message arrived in the queue
-       }
+// moves the jobs of the sub-queue that are due for promotion to the tail of the next more important one;
+// the wheel may also hand out a sub-queue whose oldest job has changed since, then nothing is due
+void Queue::promote(int priority){
+    int64_t now = simTime().raw();
+    while (!queues.isEmpty(priority) && classEntryTimes.get(priority, 0) + agingThreshold[priority].raw() <= now) {
+        simtime_t waited = simTime() - SimTime::fromRaw(classEntryTimes.get(priority, 0));
+        PriorityMessage *msg = popFromQueue(priority);
+        EV << "Promoting " << msg->getName() << " from class " << priority << " to " << priority - 1 << " after " << waited << "s" << endl;
+        emit(promotedSignal, waited);
+        emit(promotedSignals[priority], waited);
+        insertInQueue(msg, priority - 1);
     }
-}// end of handleMessage
+}
 
-int Queue::getMsgToServe(){
-    //scan sequentially from priority 0 (the most important) to the last and get the next message to Serve
-    for(int i = 0; i <= queues.size(); i++){
-        cQueue *c = (cQueue*)(queues.get(i));
-        if(c && !c->isEmpty()){
-            ASSERT(c->getLength() > 0);
-            return i;
+// whether a job that finds all the servers busy may wait in the buffer; with PUSH_OUT a full buffer
+// makes room for it by dropping the newest job of the least important class, if less important than it
+bool Queue::admit(PriorityMessage *msg){
+    int priority = msg->getPriority();
+    if (classCapacity[priority] >= 0 && getQueueLength(priority) >= classCapacity[priority])
+        return false;
+    if (capacity < 0)
+        return true;
+    if (dropPolicy == EARLY_DROP && totalQueueLength >= earlyDropStart && totalQueueLength < capacity) {
+        // the probability grows linearly from 0 at earlyDropStart to earlyDropProbability at capacity
+        double p = earlyDropProbability * (totalQueueLength - earlyDropStart + 1) / (capacity - earlyDropStart + 1);
+        if (dropRng->doubleRand() < p)
+            return false;
+    }
+    if (totalQueueLength < capacity)
+        return true;
+    if (dropPolicy == PUSH_OUT) {
+        int victim = nonEmptyQueues.findLast();
+        if (victim > priority) {
+            dropJob(popNewestFromQueue(victim), true);
+            return true;
         }
     }
-    //if they are all empty, return -1
-    return -1;
+    return false;
 }
 
-double Queue::getServiceTimeForPriority(int priority){
-    if(priority >= 0 && priority < numPrio && serviceTimes.size() > 0){
-        if (priority <= (serviceTimes.size() - 1)) return omnetpp::exponential(rng, serviceTimes.at(priority)); // if the serviceTimes array has enough values, return the correct one
-        else return omnetpp::exponential(rng, serviceTimes.at(rand() % serviceTimes.size())); // otherwise just return a random time out of all the available ones
-    }
+// drops a job refused on arrival or pushed out of the buffer, fromBuffer says which
+void Queue::dropJob(PriorityMessage *msg, bool fromBuffer){
+    int priority = msg->getPriority();
+    simtime_t waited = fromBuffer ? simTime() - msg->getTimestamp() : SIMTIME_ZERO;
+    (fromBuffer ? pushedOut : refused)[priority]++;
+    EV << "Dropping " << msg->getName() << (fromBuffer ? ", pushed out of the buffer" : ", the buffer is full") << endl;
 
-    return 0;
+    emit(droppedSignal, waited);
+    emit(droppedSignals[priority], waited);
+
+    if (pool) {
+        drop(msg);
+        pool->release(msg);
+    }
+    else
+        delete msg;
 }
 
 long Queue::getTotalQueueLength(){
-    long len = 0;
-    for (int i = 0; i < queues.size(); i++){
-        if (cQueue *queue = check_and_cast<cQueue*>(queues[i])){
-            len += queue->getLength();
-        }
+    return totalQueueLength;
+}
+
+// jobs of the class waiting, in its sub-queue or in bySize
+int Queue::getQueueLength(int priority) const{
+    return isSizeBased ? bySize.getLength(priority) : queues.getLength(priority);
+}
+
+std::string Queue::QueueView::str() const
+{
+    std::string s;
+    long total = 0;
+    for (int i = 0; i < queue->queues.getNumClasses(); i++) {
+        s += (i ? " " : "") + std::to_string(queue->getQueueLength(i));
+        total += queue->getQueueLength(i);
     }
-    return len;
+    return std::to_string(total) + " jobs, per class: " + s;
+}
+
+void Queue::QueueView::forEachChild(cVisitor *v)
+{
+    const ClassFifos<PriorityMessage*>& queues = queue->queues;
+    for (int i = 0; i < queues.getNumClasses(); i++)
+        for (int j = 0; j < queues.getLength(i); j++)
+            v->visit(queues.get(i, j));
+    queue->bySize.forEach([v](PriorityMessage *msg) { v->visit(msg); });
 }
@@ -1,5 +1,9 @@
 #include <omnetpp.h>
 #include <PriorityMessage_m.h>
+#include <ClassSignals.h>
+#include <MessagePool.h>
+#include <Profiler.h>
+#include <Logging.h>
 
 using namespace omnetpp;
 
@@ -10,19 +14,20 @@ class Sink : public cSimpleModule
     // Global
     simsignal_t responseTimeSignal;
 
-    // Per-class
-    simsignal_t responseTimeSignal0;
-    simsignal_t responseTimeSignal1;
-    simsignal_t responseTimeSignal2;
-    simsignal_t responseTimeSignal3;
-    simsignal_t responseTimeSignal4;
+    // Per-class, indexed by priority
+    std::vector<simsignal_t> responseTimeSignals;
 
     simsignal_t arrivedMsgSignal;
     int nb_arrivedMsg;
 
+    MessagePool *pool; // if set, received messages go back to the pool instead of being deleted
+
+    Profiler profiler; // Profiler.h, one branch: the departures
+
   protected:
     virtual void initialize() override;
     virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
 };
 
 Define_Module(Sink);
@@ -30,40 +35,53 @@ Define_Module(Sink);
 
 void Sink::initialize()
 {
+    applyVerbosity(this);
+
     // Global
     responseTimeSignal = registerSignal("responseTime");
 
     // Per-class
-    responseTimeSignal0 = registerSignal("responseTime0");
-    responseTimeSignal1 = registerSignal("responseTime1");
-    responseTimeSignal2 = registerSignal("responseTime2");
-    responseTimeSignal3 = registerSignal("responseTime3");
-    responseTimeSignal4 = registerSignal("responseTime4");
+    responseTimeSignals = registerClassSignals(this, "responseTime", par("numPrio").intValue());
 
     arrivedMsgSignal = registerSignal("arrivedMsg");
     nb_arrivedMsg = 0;
+
+    pool = check_and_cast_nullable<MessagePool*>(getModuleByPath("^.pool"));
+
+    profiler.init(this, {"departure"});
+    profiler.countEmits(responseTimeSignals);
+    profiler.countEmits({responseTimeSignal, arrivedMsgSignal});
 }
 
 void Sink::handleMessage(cMessage *msg)
 {
-    simtime_t lifetime = simTime() - msg->getCreationTime();
+    auto started = profiler.start();
+    PriorityMessage* prioMsg = check_and_cast<PriorityMessage*>(msg);
+    simtime_t lifetime = simTime() - prioMsg->getGenerationTime();
     EV << "Sink Received " << msg->getName() << ", lifetime: " << lifetime << "s" << endl;
 
     // Emit the global average lifetime
     emit(responseTimeSignal, lifetime);
 
     // Emit per-class lifetimes
-    PriorityMessage* prioMsg = (PriorityMessage*)msg;
-    switch (prioMsg->getPriority()){
-        case 0: emit(responseTimeSignal0, lifetime); break;
-        case 1: emit(responseTimeSignal1, lifetime); break;
-        case 2: emit(responseTimeSignal2, lifetime); break;
-        case 3: emit(responseTimeSignal3, lifetime); break;
-        case 4: emit(responseTimeSignal4, lifetime); break;
-        default: break;
-    }
+    if (prioMsg->getPriority() < 0 || prioMsg->getPriority() >= (int)responseTimeSignals.size())
+        throw cRuntimeError("Received a message with priority %d but numPrio is %d", prioMsg->getPriority(), (int)responseTimeSignals.size());
+    emit(responseTimeSignals[prioMsg->getPriority()], lifetime);
 
     nb_arrivedMsg ++;
     emit(arrivedMsgSignal, nb_arrivedMsg);
-    delete msg;
+
+    if (pool) {
+        drop(prioMsg);
+        pool->release(prioMsg);
+    }
+    else
+        delete msg;
+
+    profiler.stop(0, started);
+}
+
+void Sink::finish()
+{
+    profiler.record();
 }
@@ -1,6 +1,12 @@
 #include <omnetpp.h>
-#include <cstdlib>
 #include <PriorityMessage_m.h>
+#include <MessagePool.h>
+#include <Distribution.h>
+#include <AliasTable.h>
+#include <IndexedHeap.h>
+#include <TraceReader.h>
+#include <Profiler.h>
+#include <Logging.h>
 
 using namespace omnetpp;
 
@@ -9,13 +15,32 @@ class Source : public cSimpleModule
 {
   private:
     PriorityMessage *priorityMessage;
+    MessagePool *pool; // nullptr if the network has no pool: messages are then allocated one by one
 
     int numPrio;
-    cMersenneTwister* rng; // random number generator
-    std::vector<double> interArrivalTimes; // we default to exponential times
-
-    //Needed for taking track of id generation of messages for each priority
-    int generatedMsgCounter[100] = {0}; //obviously need to limit the max number of priority queues
+    cRNG *rng; // inter-arrival times, local RNG 0
+    cRNG *priorityRng; // priority of the jobs, local RNG 1
+    cRNG *serviceRng; // service demands, local RNG 2
+    std::vector<Distribution> interArrivalTimes; // per-class, parsed once (see Distribution.h)
+    std::vector<Distribution> serviceTimes; // per-class, empty if the Queue draws the service times
+
+    // The arrivals are the superposition of one stream per class, with a single pending self-message.
+    // If every class is Poisson they merge into one Poisson stream of the total rate, whose jobs get
+    // their class with probability proportional to its rate; otherwise the next arrival of each class
+    // is kept in a heap and the earliest one is sent.
+    bool allPoisson;
+    double totalRate;
+    AliasTable classSelector;
+    IndexedHeap<int64_t> nextArrivals; // classes by -(raw time of their next arrival): the top is the earliest
+
+    // trace replay, if traceFile is set: arrivals, priorities and service demands come from the trace
+    TraceReader *trace;
+    const TraceRecord *nextRecord; // the job sent at the next arrival
+    bool traceLoop;
+    double traceTimeScale;
+    simtime_t traceOffset; // start of the current pass over the trace
+
+    Profiler profiler; // Profiler.h, one branch: the arrivals
 
   public:
     Source();
@@ -24,7 +49,11 @@ class Source : public cSimpleModule
   protected:
     virtual void initialize() override;
     virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
     virtual double getPriorityTime(int priority);
+    virtual simtime_t getServiceDemand(int priority);
+    virtual simtime_t getNextArrival();
+    virtual simtime_t getTraceTime(const TraceRecord *record);
 };
 
 Define_Module(Source);
@@ -32,50 +61,169 @@ Define_Module(Source);
 Source::Source()
 {
     priorityMessage = nullptr;
+    pool = nullptr;
+    trace = nullptr;
 }
 
 Source::~Source()
 {
     cancelAndDelete(priorityMessage);
+    delete trace;
 }
 
 void Source::initialize()
 {
+    applyVerbosity(this);
+
     numPrio = par("numPrio").intValue(); //getting the numbers of n priorities from parameter
 
-    rng = new cMersenneTwister();
-    interArrivalTimes = cStringTokenizer(par("interArrivalTimes")).asDoubleVector();
+    // separate streams: with the same seed set, runs that differ only in the queue see the same arrivals
+    rng = getRNG(0);
+    priorityRng = getRNG(1);
+    serviceRng = getRNG(2);
+    interArrivalTimes = Distribution::parseList(par("interArrivalTimes"));
+    if (interArrivalTimes.empty())
+        throw cRuntimeError("interArrivalTimes is empty");
+    serviceTimes = Distribution::parseList(par("serviceTimes"));
+    pool = check_and_cast_nullable<MessagePool*>(getModuleByPath("^.pool"));
 
     priorityMessage = new PriorityMessage("dataPriorityMessage");
-    scheduleAt(simTime(), priorityMessage);
+    profiler.init(this, {"arrival"});
+
+    const char *traceFile = par("traceFile");
+    if (*traceFile) {
+        try {
+            trace = new TraceReader(traceFile, (size_t)par("traceWindow").intValue());
+        }
+        catch (std::exception& e) {
+            throw cRuntimeError("%s", e.what());
+        }
+        traceLoop = par("traceLoop");
+        traceTimeScale = par("traceTimeScale");
+        traceOffset = simTime();
+        nextRecord = trace->next();
+        EV << "Replaying " << trace->getNumRecords() << " arrivals from " << traceFile << endl;
+        scheduleAt(getTraceTime(nextRecord), priorityMessage);
+    }
+    else {
+        allPoisson = true;
+        std::vector<double> rates(numPrio);
+        for (int i = 0; i < numPrio; i++) {
+            const Distribution& d = interArrivalTimes[i % interArrivalTimes.size()];
+            allPoisson = allPoisson && d.getKind() == Distribution::EXPONENTIAL;
+            rates[i] = 1 / d.getMean();
+        }
+        if (allPoisson) {
+            totalRate = 0;
+            for (double rate : rates)
+                totalRate += rate;
+            classSelector = AliasTable(rates);
+        }
+        else {
+            nextArrivals.resize(numPrio);
+            for (int i = 0; i < numPrio; i++)
+                nextArrivals.push(i, -(simTime() + getPriorityTime(i)).raw());
+        }
+        scheduleAt(getNextArrival(), priorityMessage);
+    }
 }
 
 void Source::handleMessage(cMessage *msg)
 {
     ASSERT(msg == priorityMessage);
+    auto started = profiler.start();
 
-    char msgname[60];
-    int priority = (rand() % numPrio); //generating priority number from parameter
-    sprintf(msgname, "message-%d-priority-%d", ++generatedMsgCounter[priority], priority);
-    PriorityMessage *message = new PriorityMessage(msgname);
+    int priority;
+    if (trace) {
+        priority = nextRecord->priority;
+        if (priority >= numPrio)
+            throw cRuntimeError("Trace record %llu has priority %d, but numPrio is %d", (unsigned long long)trace->getPosition() - 1, priority, numPrio);
+    }
+    else if (allPoisson)
+        priority = classSelector.draw(priorityRng->doubleRand()); //each class with probability rate/totalRate
+    else
+        priority = nextArrivals.top(); //the class whose arrival is due now
+    PriorityMessage *message;
+    if (pool) {
+        message = pool->acquire();
+        take(message);
+    }
+    else
+        message = new PriorityMessage();
+    message->setJobId(getSimulation()->getUniqueNumber()); // unique across all the modules of the run
+    if (getEnvir()->isGUI() || getEnvir()->isLoggingEnabled()) { // names are only read by the GUI and the log, don't format them in batch runs
+        char msgname[60];
+        sprintf(msgname, "message-%lld-priority-%d", (long long)message->getJobId(), priority);
+        message->setName(msgname);
+    }
     message->setPriority(priority);
     message->setWorkLeft(SIMTIME_ZERO);
     message->setQueueingTime(SIMTIME_ZERO);
     message->setTimestamp(SIMTIME_ZERO);
     message->setWorkStart(SIMTIME_ZERO);
+    message->setGenerationTime(simTime());
+    message->setServiceDemand(trace ? nextRecord->serviceDemand : getServiceDemand(priority));
 
     send(message, "out");
 
-    auto prio = getPriorityTime(priority);
+    if (trace) {
+        nextRecord = trace->next();
+        if (!nextRecord && traceLoop) {
+            // the next pass starts one mean inter-arrival time after the last arrival
+            trace->rewind();
+            nextRecord = trace->next();
+            if (trace->getNumRecords() < 2)
+                throw cRuntimeError("Cannot loop a trace whose arrivals are all at the same time");
+            simtime_t firstArrival = traceOffset + nextRecord->time * traceTimeScale;
+            simtime_t meanGap = (simTime() - firstArrival) / (double)(trace->getNumRecords() - 1);
+            if (meanGap == SIMTIME_ZERO)
+                throw cRuntimeError("Cannot loop a trace whose arrivals are all at the same time");
+            traceOffset = simTime() + meanGap - nextRecord->time * traceTimeScale;
+        }
+        if (nextRecord)
+            scheduleAt(getTraceTime(nextRecord), priorityMessage);
+        else
+            EV << "End of the trace, no more arrivals" << endl;
+    }
+    else {
+        if (!allPoisson)
+            nextArrivals.update(priority, -(simTime() + getPriorityTime(priority)).raw());
+        scheduleAt(getNextArrival(), priorityMessage);
+    }
 
-    scheduleAt(simTime() + prio, priorityMessage);
+    profiler.stop(0, started);
 }
 
-double Source::getPriorityTime(int priority){
-    if(priority >= 0 && priority < numPrio && interArrivalTimes.size() > 0){
-        if (priority <= (interArrivalTimes.size() - 1)) return omnetpp::exponential(rng, interArrivalTimes.at(priority)); // if the interArrivalTimes array has enough values, return the correct one
-        else return omnetpp::exponential(rng, interArrivalTimes.at(rand() % interArrivalTimes.size())); // otherwise just return a random time out of all the available ones
-    }
+void Source::finish()
+{
+    profiler.record();
+}
+
+// time of the next arrival of any class
+simtime_t Source::getNextArrival(){
+    if (allPoisson)
+        return simTime() + omnetpp::exponential(rng, 1 / totalRate);
+    return SimTime::fromRaw(-nextArrivals.getKey(nextArrivals.top()));
+}
 
-    return 0;
+simtime_t Source::getTraceTime(const TraceRecord *record){
+    simtime_t t = traceOffset + record->time * traceTimeScale;
+    if (t < simTime())
+        throw cRuntimeError("Trace record %llu goes back in time (%g s)", (unsigned long long)trace->getPosition() - 1, record->time);
+    return t;
+}
+
+// service demand of a new job of the given class, 0 if the Queue draws it; beyond the listed classes a random
+// one of the list, as Queue::getServiceTimeForPriority() does
+simtime_t Source::getServiceDemand(int priority){
+    if (serviceTimes.empty())
+        return SIMTIME_ZERO;
+    if (priority < (int)serviceTimes.size())
+        return serviceTimes[priority].draw(serviceRng);
+    return serviceTimes[serviceRng->intRand(serviceTimes.size())].draw(serviceRng);
+}
+
+// time to the next arrival of the given class; classes beyond the listed ones reuse the list cyclically
+double Source::getPriorityTime(int priority){
+    return interArrivalTimes[priority % interArrivalTimes.size()].draw(rng);
 }
@@ -0,0 +1,180 @@
+#include <omnetpp.h>
+#include <P2Quantile.h>
+
+using namespace omnetpp;
+
+
+Register_PerObjectConfigOption(CFGID_STREAMING_QUANTILES, "streaming-quantiles", KIND_STATISTIC, CFG_STRING, "0.5 0.9 0.99", "Quantiles estimated by the 'streaming' result recorder (P-square), e.g. \"0.5 0.99\"");
+Register_PerObjectConfigOptionU(CFGID_STREAMING_RESOLUTION, "streaming-vector-resolution", KIND_STATISTIC, "s", "0s", "If non-zero, the 'streaming' result recorder also writes a vector with one averaged value per interval of this length");
+
+/**
+ * Result recorder that reduces a signal online instead of writing every value to the
+ * .vec file: count, mean, standard deviation, min, max and the quantiles set by
+ * "streaming-quantiles", written as scalars at the end of the run.
+ *
+ * For sample-hold signals (interpolationmode=sample-hold, e.g. qlen) the mean and
+ * standard deviation are time-weighted: each value counts for as long as it was held.
+ * The quantiles are always estimated over the emitted values.
+ *
+ * With "streaming-vector-resolution" set, a downsampled vector with one value per
+ * interval (the time-average, or the mean of the values emitted in it) is written too.
+ */
+class StreamingStatsRecorder : public cNumericResultRecorder
+{
+  protected:
+    bool timeWeighted;
+    long count;
+    double min, max;
+
+    // weighted incremental mean and variance (West, 1979); weights are 1 or the holding times
+    double weightSum, mean, m2;
+    simtime_t lastTime;
+    double lastValue;
+
+    std::vector<P2Quantile> quantiles;
+
+    // downsampled vector, only if resolution > 0
+    simtime_t resolution;
+    simtime_t intervalEnd;
+    double intervalSum, intervalWeight;
+    void *vectorHandle;
+
+  public:
+    StreamingStatsRecorder();
+
+  protected:
+    virtual void init(cComponent *component, const char *statisticName, const char *recordingMode, cProperty *attrsProperty, opp_string_map *manualAttrs=nullptr) override;
+    virtual void collect(simtime_t_cref t, double value, cObject *details) override;
+    virtual void finish(cResultFilter *prev) override;
+    virtual void addWeighted(double value, double weight);
+    virtual void advanceTo(simtime_t t);
+};
+
+Register_ResultRecorder("streaming", StreamingStatsRecorder);
+
+
+StreamingStatsRecorder::StreamingStatsRecorder()
+{
+    timeWeighted = false;
+    count = 0;
+    min = max = NAN;
+    weightSum = mean = m2 = 0;
+    lastTime = -1;
+    lastValue = 0;
+    intervalSum = intervalWeight = 0;
+    vectorHandle = nullptr;
+}
+
+void StreamingStatsRecorder::init(cComponent *component, const char *statisticName, const char *recordingMode, cProperty *attrsProperty, opp_string_map *manualAttrs)
+{
+    cNumericResultRecorder::init(component, statisticName, recordingMode, attrsProperty, manualAttrs);
+
+    opp_string_map attributes = getStatisticAttributes();
+    timeWeighted = attributes["interpolationmode"] == "sample-hold";
+
+    std::string objectPath = component->getFullPath() + "." + statisticName;
+    cConfiguration *config = getEnvir()->getConfig();
+    for (double p : cStringTokenizer(config->getAsString(objectPath.c_str(), CFGID_STREAMING_QUANTILES).c_str()).asDoubleVector()) {
+        if (p <= 0 || p >= 1)
+            throw cRuntimeError("streaming-quantiles for %s: %g is not in (0,1)", objectPath.c_str(), p);
+        quantiles.push_back(P2Quantile(p));
+    }
+
+    resolution = config->getAsDouble(objectPath.c_str(), CFGID_STREAMING_RESOLUTION, 0);
+    if (resolution > SIMTIME_ZERO) {
+        intervalEnd = simTime() + resolution;
+        vectorHandle = getEnvir()->registerOutputVector(component->getFullPath().c_str(), (std::string(statisticName) + ":streaming").c_str());
+        for (auto& attr : attributes)
+            getEnvir()->setVectorAttribute(vectorHandle, attr.first.c_str(), attr.second.c_str());
+    }
+}
+
+void StreamingStatsRecorder::addWeighted(double value, double weight)
+{
+    weightSum += weight;
+    double delta = value - mean;
+    mean += delta * weight / weightSum;
+    m2 += weight * delta * (value - mean);
+}
+
+// closes the intervals of the downsampled vector that end before t, and accounts the held value up to t
+void StreamingStatsRecorder::advanceTo(simtime_t t)
+{
+    while (t >= intervalEnd) {
+        if (timeWeighted && lastTime >= SIMTIME_ZERO) {
+            intervalSum += lastValue * (intervalEnd - lastTime).dbl();
+            intervalWeight += (intervalEnd - lastTime).dbl();
+            lastTime = intervalEnd;
+        }
+        if (intervalWeight > 0)
+            getEnvir()->recordInOutputVector(vectorHandle, intervalEnd, intervalSum / intervalWeight);
+        intervalSum = intervalWeight = 0;
+        intervalEnd += resolution;
+    }
+    if (timeWeighted && lastTime >= SIMTIME_ZERO) {
+        intervalSum += lastValue * (t - lastTime).dbl();
+        intervalWeight += (t - lastTime).dbl();
+    }
+}
+
+void StreamingStatsRecorder::collect(simtime_t_cref t, double value, cObject *details)
+{
+    if (count++ == 0)
+        min = max = value;
+    else if (value < min)
+        min = value;
+    else if (value > max)
+        max = value;
+
+    for (auto& quantile : quantiles)
+        quantile.collect(value);
+
+    if (timeWeighted) {
+        if (lastTime >= SIMTIME_ZERO && t > lastTime) {
+            // the accounting of the downsampled vector moves lastTime, take the weight first
+            double weight = (t - lastTime).dbl();
+            if (vectorHandle)
+                advanceTo(t);
+            addWeighted(lastValue, weight);
+        }
+        lastTime = t;
+        lastValue = value;
+    }
+    else {
+        addWeighted(value, 1);
+        if (vectorHandle) {
+            advanceTo(t);
+            intervalSum += value;
+            intervalWeight += 1;
+        }
+    }
+}
+
+void StreamingStatsRecorder::finish(cResultFilter *prev)
+{
+    if (timeWeighted && lastTime >= SIMTIME_ZERO && simTime() > lastTime) {
+        double weight = (simTime() - lastTime).dbl();
+        if (vectorHandle)
+            advanceTo(simTime());
+        addWeighted(lastValue, weight);
+    }
+    if (vectorHandle && intervalWeight > 0) // the last, partial interval
+        getEnvir()->recordInOutputVector(vectorHandle, simTime(), intervalSum / intervalWeight);
+
+    opp_string_map attributes = getStatisticAttributes();
+    std::string prefix = std::string(getStatisticName()) + ":streaming.";
+    auto record = [&](const std::string& name, double value) {
+        getEnvir()->recordScalar(getComponent(), (prefix + name).c_str(), value, &attributes);
+    };
+
+    record("count", count);
+    record("mean", weightSum > 0 ? mean : NAN);
+    record("stddev", weightSum > 0 ? sqrt(m2 / weightSum) : NAN);
+    record("min", min);
+    record("max", max);
+    for (auto& quantile : quantiles) {
+        char name[32];
+        sprintf(name, "p%g", quantile.getQuantile() * 100);
+        record(name, quantile.get());
+    }
+}
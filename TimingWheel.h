@@ -0,0 +1,67 @@
+#ifndef __TIMINGWHEEL_H
+#define __TIMINGWHEEL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Hashed timing wheel (Varghese and Lauck) for items due at most "span" after the current
+ * time: time is cut in slots of a fixed width, and an item goes to the bucket of its slot,
+ * modulo the number of buckets, which covers the span. advance() hands out the items of
+ * every slot that has ended, all due by then, so adding an item and handing it out are
+ * O(1), at the price of a delay of up to one slot. Items are ints (e.g. a class); times
+ * are integers (raw simulation times).
+ */
+class TimingWheel
+{
+  private:
+    std::vector<std::vector<int>> buckets;
+    int64_t width;  // of a slot
+    int64_t cursor; // next slot to hand out
+    size_t count;
+    std::vector<int> due; // scratch for advance(), swapped with the buckets so neither loses its capacity
+
+  public:
+    TimingWheel() { resize(1, 0); }
+
+    // empty, with slots of the given width, for items due up to span after the current time
+    void resize(int64_t width, int64_t span) {
+        buckets.assign(span / width + 2, std::vector<int>());
+        this->width = width;
+        cursor = 0;
+        count = 0;
+    }
+
+    bool isEmpty() const { return count == 0; }
+
+    // end of the slot to hand out next, when advance() should be called
+    int64_t getNextTick() const { return (cursor + 1) * width; }
+
+    // item is due at time due, between now and now + span
+    void add(int64_t now, int64_t due, int item) {
+        if (count == 0)
+            cursor = now / width; // nothing between the last advance() and now
+        int64_t slot = std::max((due + width - 1) / width - 1, cursor); // the slot that ends at or just after due
+        buckets[slot % buckets.size()].push_back(item);
+        count++;
+    }
+
+    // calls f(item) for the items of every slot that has ended by now, in order of slots; f may add items
+    template <typename F>
+    void advance(int64_t now, F f) {
+        while (count > 0 && (cursor + 1) * width <= now) {
+            due.clear();
+            std::swap(due, buckets[cursor % buckets.size()]);
+            count -= due.size();
+            cursor++;
+            for (int item : due)
+                f(item);
+        }
+        if (count == 0)
+            cursor = std::max(cursor, now / width);
+    }
+};
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef __TRACEREADER_H
+#define __TRACEREADER_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Binary arrival trace: a TraceHeader followed by numRecords TraceRecords, in the byte
+ * order of the machine that wrote it (tools/TraceConvert makes one from a text file).
+ * Times are in seconds from the start of the trace and must not decrease.
+ */
+struct TraceHeader {
+    char magic[8];       // "PRIOTRC1"
+    uint32_t version;    // 1
+    uint32_t recordSize; // sizeof(TraceRecord)
+    uint64_t numRecords;
+};
+
+struct TraceRecord {
+    double time;
+    float serviceDemand; // seconds, 0 to let the Queue draw the service time
+    uint16_t priority;
+    uint16_t reserved;
+};
+
+static_assert(sizeof(TraceHeader) == 24 && sizeof(TraceRecord) == 16, "unexpected padding in the trace format");
+
+/**
+ * Sequential, zero-copy reader of a binary trace: the file is memory-mapped one window
+ * at a time, next() returns pointers into the mapping, and the window that follows is
+ * prefetched into the page cache while the current one is read. Only one window is
+ * mapped, so replaying a trace of any length takes windowBytes of memory.
+ * Without mmap (Windows) the window is read into a buffer instead.
+ */
+class TraceReader
+{
+  private:
+    std::string fileName;
+    uint64_t numRecords;
+    uint64_t windowRecords; // records per window
+    uint64_t windowFirst;   // index of the first record of the window
+    uint64_t windowEnd;     // one past the last record of the window
+    uint64_t nextIndex;
+    const TraceRecord *records; // the window, records[0] is windowFirst
+#ifndef _WIN32
+    int fd;
+    void *mapping;
+    size_t mappingLength;
+#else
+    FILE *file;
+    std::vector<TraceRecord> buffer;
+#endif
+
+    void fail(const std::string& what) const { throw std::runtime_error("trace " + fileName + ": " + what); }
+
+    void unmap() {
+#ifndef _WIN32
+        if (mapping)
+            munmap(mapping, mappingLength);
+        mapping = nullptr;
+#endif
+        records = nullptr;
+    }
+
+    void loadWindow(uint64_t first) {
+        unmap();
+        windowFirst = first;
+        windowEnd = std::min(numRecords, first + windowRecords);
+        uint64_t offset = sizeof(TraceHeader) + first * sizeof(TraceRecord);
+        size_t length = (windowEnd - first) * sizeof(TraceRecord);
+#ifndef _WIN32
+        // mmap offsets must be page-aligned: map from the page the window starts in
+        uint64_t page = sysconf(_SC_PAGESIZE);
+        uint64_t aligned = offset / page * page;
+        mappingLength = length + (offset - aligned);
+        mapping = mmap(nullptr, mappingLength, PROT_READ, MAP_PRIVATE, fd, aligned);
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+            fail(std::string("mmap failed: ") + strerror(errno));
+        }
+        madvise(mapping, mappingLength, MADV_SEQUENTIAL);
+        records = (const TraceRecord *)((const char *)mapping + (offset - aligned));
+#ifdef POSIX_FADV_WILLNEED
+        // read-ahead: let the kernel load the next window while this one is replayed
+        if (windowEnd < numRecords)
+            posix_fadvise(fd, offset + length, std::min<uint64_t>(numRecords - windowEnd, windowRecords) * sizeof(TraceRecord), POSIX_FADV_WILLNEED);
+#endif
+#else
+        buffer.resize(windowEnd - first);
+        if (_fseeki64(file, offset, SEEK_SET) != 0 || fread(buffer.data(), 1, length, file) != length)
+            fail("read failed");
+        records = buffer.data();
+#endif
+    }
+
+  public:
+    TraceReader(const char *fileName, size_t windowBytes = 64 << 20) : fileName(fileName) {
+        records = nullptr;
+        windowFirst = windowEnd = nextIndex = 0;
+        windowRecords = std::max<uint64_t>(windowBytes / sizeof(TraceRecord), 1);
+        TraceHeader header;
+#ifndef _WIN32
+        mapping = nullptr;
+        fd = open(fileName, O_RDONLY);
+        if (fd < 0)
+            fail(strerror(errno));
+        struct stat st;
+        if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+            close(fd);
+            fail("cannot read the header");
+        }
+        uint64_t fileSize = st.st_size;
+#else
+        file = fopen(fileName, "rb");
+        if (!file)
+            fail("cannot open");
+        _fseeki64(file, 0, SEEK_END);
+        uint64_t fileSize = _ftelli64(file);
+        _fseeki64(file, 0, SEEK_SET);
+        if (fread(&header, sizeof(header), 1, file) != 1) {
+            fclose(file);
+            fail("cannot read the header");
+        }
+#endif
+        numRecords = header.numRecords;
+        std::string error;
+        if (memcmp(header.magic, "PRIOTRC1", 8) != 0)
+            error = "not a trace file (bad magic)";
+        else if (header.version != 1 || header.recordSize != sizeof(TraceRecord))
+            error = "unsupported version or record size (written on a machine with a different byte order?)";
+        else if (fileSize < sizeof(TraceHeader) + numRecords * sizeof(TraceRecord))
+            error = "truncated, the header announces more records than the file holds";
+        else if (numRecords == 0)
+            error = "no records";
+        if (!error.empty()) {
+#ifndef _WIN32
+            close(fd);
+#else
+            fclose(file);
+#endif
+            fail(error);
+        }
+        loadWindow(0);
+    }
+
+    ~TraceReader() {
+        unmap();
+#ifndef _WIN32
+        close(fd);
+#else
+        fclose(file);
+#endif
+    }
+
+    uint64_t getNumRecords() const { return numRecords; }
+    uint64_t getPosition() const { return nextIndex; }
+
+    // the next record, valid until the following call; nullptr at the end of the trace
+    const TraceRecord *next() {
+        if (nextIndex == numRecords)
+            return nullptr;
+        if (nextIndex >= windowEnd || nextIndex < windowFirst)
+            loadWindow(nextIndex);
+        return &records[nextIndex++ - windowFirst];
+    }
+
+    // restarts from the first record
+    void rewind() { nextIndex = 0; }
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef __WORKHEAP_H
+#define __WORKHEAP_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <IndexedHeap.h>
+
+/**
+ * The waiting jobs of the size-based policies (SJF, SRPT) of a Queue: an indexed min-heap
+ * (IndexedHeap.h) on the work every job has left, the oldest first among equals, so the
+ * job with the least work is found in O(1) and pushed or popped in O(log n). The jobs sit
+ * in slots that are reused as they come and go, and the jobs of every class are counted.
+ */
+template <typename T>
+class WorkHeap
+{
+  private:
+    std::vector<T> items;       // by slot
+    std::vector<int> classes;   // by slot
+    std::vector<int> freeSlots;
+    IndexedHeap<std::pair<int64_t, int64_t>> heap; // slots by (-work, -arrival order): the top has the least work
+    std::vector<int> lengths;   // per class
+    int64_t nextSeq;
+
+  public:
+    WorkHeap(int numClasses = 0) { resize(numClasses); }
+
+    // empty, for classes 0..numClasses-1
+    void resize(int numClasses) {
+        items.clear();
+        classes.clear();
+        freeSlots.clear();
+        heap.resize(0);
+        lengths.assign(numClasses, 0);
+        nextSeq = 0;
+    }
+
+    bool isEmpty() const { return heap.isEmpty(); }
+    int getLength() const { return heap.size(); }
+    int getLength(int c) const { return lengths[c]; }
+
+    void push(int c, int64_t work, const T& item) {
+        int slot;
+        if (freeSlots.empty()) {
+            slot = items.size();
+            items.push_back(item);
+            classes.push_back(c);
+            heap.grow(items.size());
+        }
+        else {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            items[slot] = item;
+            classes[slot] = c;
+        }
+        heap.push(slot, std::make_pair(-work, -nextSeq++));
+        lengths[c]++;
+    }
+
+    // class of the job with the least work, the heap must not be empty
+    int peekClass() const { return classes[heap.top()]; }
+
+    // removes and returns the job with the least work, the heap must not be empty
+    T pop() {
+        int slot = heap.pop();
+        freeSlots.push_back(slot);
+        lengths[classes[slot]]--;
+        return items[slot];
+    }
+
+    // calls f(item) for every job, in no particular order
+    template <typename F>
+    void forEach(F f) const {
+        for (int slot = 0; slot < (int)items.size(); slot++)
+            if (heap.contains(slot))
+                f(items[slot]);
+    }
+};
+
+#endif
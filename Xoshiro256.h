@@ -0,0 +1,75 @@
+#ifndef __XOSHIRO256_H
+#define __XOSHIRO256_H
+
+#include <cstdint>
+
+/**
+ * xoshiro256** (Blackman & Vigna, 2018): 256 bits of state, period 2^256-1, a few
+ * shifts and rotations per 64-bit number. jump() advances the state by 2^128 numbers,
+ * which splits one seed into non-overlapping streams.
+ */
+class Xoshiro256
+{
+  private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+  public:
+    Xoshiro256(uint64_t seed = 0) { setSeed(seed); }
+
+    // fills the state with splitmix64 of the seed, as recommended by the authors (never all zero)
+    void setSeed(uint64_t seed) {
+        for (int i = 0; i < 4; i++) {
+            uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            s[i] = z ^ (z >> 31);
+        }
+    }
+
+    void setState(uint64_t s0, uint64_t s1, uint64_t s2, uint64_t s3) { s[0] = s0; s[1] = s1; s[2] = s2; s[3] = s3; }
+
+    uint64_t next() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    void jump() {
+        static const uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+        uint64_t t[4] = {0, 0, 0, 0};
+        for (uint64_t j : JUMP) {
+            for (int b = 0; b < 64; b++) {
+                if (j & (1ULL << b))
+                    for (int i = 0; i < 4; i++)
+                        t[i] ^= s[i];
+                next();
+            }
+        }
+        for (int i = 0; i < 4; i++)
+            s[i] = t[i];
+    }
+
+    // uniform in [0,n) without modulo bias (Lemire, 2019), n > 0
+    uint32_t nextBelow(uint32_t n) {
+        uint64_t m = (uint64_t)(uint32_t)(next() >> 32) * n;
+        if ((uint32_t)m < n) {
+            uint32_t threshold = -n % n;
+            while ((uint32_t)m < threshold)
+                m = (uint64_t)(uint32_t)(next() >> 32) * n;
+        }
+        return m >> 32;
+    }
+
+    // [0,1), with the 53 high bits
+    double nextDouble() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+#endif
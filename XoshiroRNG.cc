@@ -0,0 +1,90 @@
+#include <omnetpp.h>
+#include <Xoshiro256.h>
+
+using namespace omnetpp;
+
+
+/**
+ * RNG class on xoshiro256** (Xoshiro256.h), faster than the default Mersenne Twister.
+ * Select it in omnetpp.ini with: rng-class = "XoshiroRNG"
+ *
+ * Every RNG of a run starts from the seed set and is then jumped ahead by 2^128 numbers
+ * per RNG index (and per partition under parallel simulation), so the streams of a seed
+ * set never overlap.
+ */
+class XoshiroRNG : public cRNG
+{
+  protected:
+    Xoshiro256 gen;
+
+  public:
+    XoshiroRNG() {}
+
+    virtual void initialize(int seedSet, int rngId, int numRngs, int parsimProcId, int parsimNumPartitions, cConfiguration *cfg) override;
+    virtual void selfTest() override;
+    virtual uint32_t intRand() override;
+    virtual uint32_t intRandMax() override;
+    virtual uint32_t intRand(uint32_t n) override;
+    virtual double doubleRand() override;
+    virtual double doubleRandNonz() override;
+    virtual double doubleRandIncl1() override;
+};
+
+Register_Class(XoshiroRNG);
+
+
+void XoshiroRNG::initialize(int seedSet, int rngId, int numRngs, int parsimProcId, int parsimNumPartitions, cConfiguration *cfg)
+{
+    gen.setSeed(seedSet);
+    for (int i = 0; i < parsimProcId * numRngs + rngId; i++)
+        gen.jump();
+    numDrawn = 0;
+}
+
+void XoshiroRNG::selfTest()
+{
+    // reference output of xoshiro256** from the state {1, 2, 3, 4}
+    static const uint64_t expected[] = {11520ULL, 0ULL, 1509978240ULL, 1215971899390074240ULL};
+    Xoshiro256 test;
+    test.setState(1, 2, 3, 4);
+    for (uint64_t e : expected)
+        if (test.next() != e)
+            throw cRuntimeError("XoshiroRNG: selfTest() failed, please report this problem!");
+}
+
+uint32_t XoshiroRNG::intRand()
+{
+    numDrawn++;
+    return gen.next() >> 32;
+}
+
+uint32_t XoshiroRNG::intRandMax()
+{
+    return 0xffffffffUL;
+}
+
+uint32_t XoshiroRNG::intRand(uint32_t n)
+{
+    if (n == 0)
+        throw cRuntimeError("XoshiroRNG: intRand(0) called");
+    numDrawn++;
+    return gen.nextBelow(n);
+}
+
+double XoshiroRNG::doubleRand()
+{
+    numDrawn++;
+    return gen.nextDouble();
+}
+
+double XoshiroRNG::doubleRandNonz()
+{
+    numDrawn++;
+    return ((gen.next() >> 12) + 0.5) * (1.0 / 4503599627370496.0);
+}
+
+double XoshiroRNG::doubleRandIncl1()
+{
+    numDrawn++;
+    return (gen.next() >> 11) * (1.0 / 9007199254740991.0);
+}
@@ -0,0 +1,77 @@
+//
+// Microbenchmark of the future event set with N pending timers (the classic "hold" model:
+// remove the earliest event, schedule it again an exponential time later), as with N Sources
+// each waiting for its next arrival: a binary heap keyed like the default cEventHeap (time,
+// priority, insertion order) against the calendar queue of CalendarEventSet (CalendarQueue.h).
+//
+// Standalone program (no simulation kernel needed), build and run it with "make microbench".
+// Usage: FesBench [holds per size]
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <vector>
+#include <CalendarQueue.h>
+
+typedef CalendarQueue<int>::Entry Entry;
+
+static const int64_t SECOND = 1000000000000LL; // raw simulation time units, with the default picosecond precision
+
+struct Later {
+    bool operator()(const Entry& a, const Entry& b) const { return b < a; }
+};
+
+// ns per hold of "hold", which takes the random generator and the time of the next event to schedule
+template <typename Hold>
+static double run(long n, Hold hold)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < n; i++)
+        hold();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / n;
+}
+
+int main(int argc, char **argv)
+{
+    long holds = argc > 1 ? atol(argv[1]) : 5000000;
+    printf("holds=%ld per size, mean timer 1s per source\n", holds);
+    printf("%-10s %14s %14s %10s\n", "timers", "heap ns/hold", "calendar ns", "speedup");
+
+    for (int n : {10, 100, 1000, 10000, 100000}) {
+        std::exponential_distribution<double> exponential(1.0);
+        int64_t checksum = 0;
+
+        std::mt19937_64 rng(1);
+        std::priority_queue<Entry, std::vector<Entry>, Later> heap;
+        int64_t seq = 0;
+        for (int i = 0; i < n; i++)
+            heap.push(Entry{(int64_t)(exponential(rng) * SECOND), 0, seq++, i});
+        double heapNs = run(holds, [&]() {
+            Entry e = heap.top();
+            heap.pop();
+            checksum += e.item;
+            heap.push(Entry{e.time + (int64_t)(exponential(rng) * SECOND), 0, seq++, e.item});
+        });
+
+        rng.seed(1);
+        CalendarQueue<int> calendar;
+        for (int i = 0; i < n; i++)
+            calendar.insert((int64_t)(exponential(rng) * SECOND), 0, i);
+        double calendarNs = run(holds, [&]() {
+            int64_t time = calendar.peekFirst().time;
+            int item = calendar.removeFirst();
+            checksum -= item;
+            calendar.insert(time + (int64_t)(exponential(rng) * SECOND), 0, item);
+        });
+
+        // both serve the same events in the same order, so the checksum cancels out
+        if (checksum != 0)
+            fprintf(stderr, "warning: the two event sets served different events\n");
+        printf("%-10d %14.2f %14.2f %10.2f\n", n, heapNs, calendarNs, heapNs / calendarNs);
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+//
+// Microbenchmark of the "next sub-queue to serve" lookup done by Queue::getMsgToServe():
+// the old sequential scan over the per-priority queues against the PriorityBitmap dispatcher.
+//
+// Standalone program (no simulation kernel needed), build and run it with "make microbench".
+// Usage: PriorityBitmapBench [backlog] [operations]  (operations are scaled down above 64 classes)
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <random>
+#include <vector>
+#include <PriorityBitmap.h>
+
+// the old lookup: scan sequentially from priority 0 (the most important) to the last
+static int scanFirst(const std::vector<std::deque<int>>& queues)
+{
+    for (int i = 0; i < (int)queues.size(); i++)
+        if (!queues[i].empty())
+            return i;
+    return -1;
+}
+
+// Keeps "backlog" jobs in the system: every operation serves the most important job and
+// lets a new one arrive with a uniformly drawn priority, like a saturated M/M/1 queue does.
+// With strict priority the backlog drifts to the least important classes, which is exactly
+// the case the old scan is slowest at.
+template <typename Lookup, typename OnInsert, typename OnPop>
+static double run(int numPrio, const std::vector<int>& arrivals, int backlog, long& checksum,
+                  Lookup lookup, OnInsert onInsert, OnPop onPop)
+{
+    std::vector<std::deque<int>> queues(numPrio);
+    size_t next = 0;
+    for (int i = 0; i < backlog; i++) {
+        int p = arrivals[next++ % arrivals.size()];
+        queues[p].push_back(i);
+        onInsert(p);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t op = 0; op < arrivals.size(); op++) {
+        int p = lookup(queues);
+        checksum += p;
+        queues[p].pop_front();
+        if (queues[p].empty())
+            onPop(p);
+
+        int arrived = arrivals[next++ % arrivals.size()];
+        queues[arrived].push_back((int)op);
+        onInsert(arrived);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / arrivals.size();
+}
+
+int main(int argc, char **argv)
+{
+    int backlog = argc > 1 ? atoi(argv[1]) : 32;
+    long ops = argc > 2 ? atol(argv[2]) : 2000000;
+    const int classes[] = {5, 64, 1024, 65536};
+
+    printf("backlog=%d operations=%ld\n", backlog, ops);
+    printf("%8s %14s %14s %9s\n", "classes", "scan ns/op", "bitmap ns/op", "speedup");
+
+    for (int numPrio : classes) {
+        std::mt19937 gen(12345);
+        std::uniform_int_distribution<int> prio(0, numPrio - 1);
+        // the old scan is O(numPrio) per operation: fewer operations for many classes keep the run short
+        long n = std::max(ops * 64 / std::max(numPrio, 64), 1000L);
+        std::vector<int> arrivals(n);
+        for (auto& p : arrivals)
+            p = prio(gen);
+
+        long scanSum = 0, bitmapSum = 0;
+        double scanNs = run(numPrio, arrivals, backlog, scanSum,
+                [](const std::vector<std::deque<int>>& q) { return scanFirst(q); },
+                [](int) {}, [](int) {});
+
+        PriorityBitmap nonEmpty(numPrio);
+        double bitmapNs = run(numPrio, arrivals, backlog, bitmapSum,
+                [&nonEmpty](const std::vector<std::deque<int>>&) { return nonEmpty.findFirst(); },
+                [&nonEmpty](int p) { nonEmpty.set(p); },
+                [&nonEmpty](int p) { nonEmpty.clear(p); });
+
+        if (scanSum != bitmapSum) {
+            fprintf(stderr, "mismatch for %d classes: scan and bitmap served different queues\n", numPrio);
+            return 1;
+        }
+        printf("%8d %14.1f %14.1f %8.1fx\n", numPrio, scanNs, bitmapNs, scanNs / bitmapNs);
+    }
+    return 0;
+}
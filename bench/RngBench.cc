@@ -0,0 +1,59 @@
+//
+// Microbenchmark of the random draws made per job: a priority in [0,numPrio) and an
+// exponential time, with libc rand(), the Mersenne Twister (the default RNG class,
+// cMersenneTwister, is the same algorithm as std::mt19937) and xoshiro256** (XoshiroRNG).
+//
+// Standalone program (no simulation kernel needed), build and run it with "make microbench".
+// Usage: RngBench [draws]
+//
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <Xoshiro256.h>
+
+// ns per job of "draw", which returns an exponential time and adds the priority to checksum
+template <typename Draw>
+static double run(long n, double& checksum, Draw draw)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < n; i++)
+        checksum += draw();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / n;
+}
+
+int main(int argc, char **argv)
+{
+    long n = argc > 1 ? atol(argv[1]) : 20000000;
+    const int numPrio = 5;
+    const double mean = 0.25;
+    double checksum = 0;
+
+    srand(1);
+    double randNs = run(n, checksum, [&]() {
+        int priority = rand() % numPrio;
+        return priority - mean * log(1 - rand() / (RAND_MAX + 1.0));
+    });
+
+    std::mt19937 mt(1);
+    double mtNs = run(n, checksum, [&]() {
+        int priority = mt() % numPrio;
+        return priority - mean * log(1 - mt() * (1.0 / 4294967296.0));
+    });
+
+    Xoshiro256 xo(1);
+    double xoNs = run(n, checksum, [&]() {
+        int priority = xo.nextBelow(numPrio);
+        return priority - mean * log(1 - xo.nextDouble());
+    });
+
+    printf("draws=%ld (checksum %g)\n", n, checksum);
+    printf("%-18s %10s\n", "generator", "ns/job");
+    printf("%-18s %10.2f\n", "libc rand()", randNs);
+    printf("%-18s %10.2f\n", "mersenne twister", mtNs);
+    printf("%-18s %10.2f\n", "xoshiro256**", xoNs);
+    return 0;
+}
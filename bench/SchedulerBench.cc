@@ -0,0 +1,95 @@
+//
+// Microbenchmark of the cost per scheduling decision of the Queue policies as the number of
+// classes grows: strict priority (PriorityBitmap), weighted fair queueing (WfqScheduler, a heap
+// of the non-empty classes) and deficit round robin (DrrScheduler, a circular list of them).
+// Every operation serves the job the policy picks and lets a new one arrive in a uniformly
+// drawn class with an exponential size, keeping the backlog constant as in a saturated queue.
+//
+// Standalone program (no simulation kernel needed), build and run it with "make microbench".
+// Usage: SchedulerBench [backlog per class] [operations]
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <ClassFifos.h>
+#include <FairQueueing.h>
+#include <PriorityBitmap.h>
+
+struct Job {
+    int cls;
+    double size;
+};
+
+// ns per decision; next() picks the class to serve, push(c, size) and pop(c) keep the policy in step with the FIFOs
+template <typename Next, typename Push, typename Pop>
+static double run(int numClasses, const std::vector<Job>& arrivals, int backlog, long& checksum, Next next, Push push, Pop pop)
+{
+    ClassFifos<double> fifos(numClasses);
+    size_t k = 0;
+    for (long i = 0; i < (long)backlog * numClasses; i++) {
+        const Job& j = arrivals[k++ % arrivals.size()];
+        fifos.push(j.cls, j.size);
+        push(j.cls, j.size);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t op = 0; op < arrivals.size(); op++) {
+        int c = next();
+        checksum += c;
+        fifos.pop(c);
+        pop(c, fifos.isEmpty(c));
+
+        const Job& j = arrivals[k++ % arrivals.size()];
+        fifos.push(j.cls, j.size);
+        push(j.cls, j.size);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / arrivals.size();
+}
+
+int main(int argc, char **argv)
+{
+    int backlog = argc > 1 ? atoi(argv[1]) : 4;
+    long operations = argc > 2 ? atol(argv[2]) : 5000000;
+    printf("backlog=%d jobs per class, operations=%ld\n", backlog, operations);
+    printf("%-8s %14s %14s %14s\n", "classes", "priority ns", "wfq ns", "drr ns");
+
+    for (int n : {5, 64, 1024, 4096}) {
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<int> uniform(0, n - 1);
+        std::exponential_distribution<double> exponential(1.0);
+        std::vector<Job> arrivals(operations);
+        for (auto& j : arrivals)
+            j = Job{uniform(rng), exponential(rng)};
+        std::vector<double> weights(n);
+        for (int c = 0; c < n; c++)
+            weights[c] = 1 + c % 4;
+        long checksum = 0;
+
+        PriorityBitmap bitmap(n);
+        double priorityNs = run(n, arrivals, backlog, checksum,
+            [&]() { return bitmap.findFirst(); },
+            [&](int c, double) { bitmap.set(c); },
+            [&](int c, bool empty) { if (empty) bitmap.clear(c); });
+
+        WfqScheduler wfq;
+        wfq.resize(weights);
+        double wfqNs = run(n, arrivals, backlog, checksum,
+            [&]() { return wfq.next(); },
+            [&](int c, double size) { wfq.push(c, size); },
+            [&](int c, bool) { wfq.pop(c); });
+
+        DrrScheduler drr;
+        drr.resize(weights, 1.0);
+        double drrNs = run(n, arrivals, backlog, checksum,
+            [&]() { return drr.next(); },
+            [&](int c, double size) { drr.push(c, size); },
+            [&](int c, bool) { drr.pop(c); });
+
+        printf("%-8d %14.2f %14.2f %14.2f   (checksum %ld)\n", n, priorityNs, wfqNs, drrNs, checksum);
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+#!/bin/sh
+#
+# Throughput benchmark: runs every scenario (number of classes x load x mode x recording)
+# one at a time, headless in Cmdenv with the Bench configuration of omnetpp.ini, and writes
+# results/bench/summary.csv with the events/sec, peak RSS and result file size of each.
+# Run from the project directory, or with "make MODE=release bench":
+#   bench/bench.sh [-p program] [-n jobs] [-b baseline.csv] [-t tolerance] [-s save.csv]
+# -n is the number of jobs simulated per scenario, so that all scenarios handle about the same
+# number of events. -b compares the events/sec with a summary saved earlier (e.g. with -s) and
+# fails if a scenario is more than tolerance percent slower (default 5).
+# The scenarios can be narrowed with CLASSES, LOADS, MODES and RECORDING in the environment.
+#
+PROGRAM=./Project_fast
+JOBS=200000
+BASELINE=
+TOLERANCE=5
+SAVE=
+RESULTS=results/bench
+CLASSES=${CLASSES:-5 64 1024}
+LOADS=${LOADS:-0.5 0.8 0.9 0.95 0.99}
+MODES=${MODES:-nonpreemptive restart resume wfq drr sjf srpt}
+RECORDING=${RECORDING:-scalars vectors}
+
+while getopts p:n:b:t:s: opt; do
+    case $opt in
+        p) PROGRAM=$OPTARG ;;
+        n) JOBS=$OPTARG ;;
+        b) BASELINE=$OPTARG ;;
+        t) TOLERANCE=$OPTARG ;;
+        s) SAVE=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+
+[ -x "$PROGRAM" ] || { echo "build $PROGRAM first (make MODE=release fast)"; exit 1; }
+[ -z "$BASELINE" ] || [ -r "$BASELINE" ] || { echo "cannot read the baseline $BASELINE"; exit 1; }
+
+# peak RSS from GNU time if there is one
+TIME=
+/usr/bin/time -f %M -o /dev/null true 2>/dev/null && TIME="/usr/bin/time -f %M -o"
+
+now() { date +%s.%N; }
+
+rm -rf $RESULTS
+mkdir -p $RESULTS
+SUMMARY=$RESULTS/summary.csv
+echo "classes,load,mode,recording,jobs,events,seconds,eventsPerSecond,peakRssKiB,resultBytes" >$SUMMARY
+
+for classes in $CLASSES; do
+for load in $LOADS; do
+for mode in $MODES; do
+for recording in $RECORDING; do
+    case $mode in
+        nonpreemptive) preemptive=false; resume=false; policy=priority ;;
+        restart) preemptive=true; resume=false; policy=priority ;;
+        resume) preemptive=true; resume=true; policy=priority ;;
+        wfq|drr|sjf|srpt) preemptive=false; resume=false; policy=$mode ;; # srpt preempts all the same
+        *) echo "unknown mode $mode"; exit 1 ;;
+    esac
+    case $recording in
+        scalars) modes=default ;;
+        vectors) modes=+vector ;;
+        *) echo "unknown recording $recording"; exit 1 ;;
+    esac
+    # every job needs 1s of service on average: the load is the total arrival rate, split evenly among the classes
+    interArrival=$(awk "BEGIN { print $classes / $load }")
+    limit=$(awk "BEGIN { print $JOBS / $load }")
+    scenario=$classes-$load-$mode-$recording
+    dir=$RESULTS/$scenario
+    mkdir -p $dir
+
+    start=$(now)
+    $TIME ${TIME:+$dir/rss} $PROGRAM -u Cmdenv -c Bench -r 0 --result-dir=$dir --sim-time-limit=${limit}s \
+        --cmdenv-express-mode=true --cmdenv-performance-display=false \
+        "--**.numPrio=$classes" "--**.gen[*].interArrivalTimes=\"$interArrival\"" \
+        "--**.queue.preemptive=$preemptive" "--**.queue.resume=$resume" "--**.queue.policy=\"$policy\"" \
+        "--**.result-recording-modes=$modes" >$dir/log 2>&1 \
+        || { echo "scenario $scenario failed, see $dir/log"; exit 1; }
+    end=$(now)
+
+    events=$(sed -n 's/.*[Ee]vent #\([0-9]*\).*/\1/p' $dir/log | tail -1)
+    [ -n "$events" ] || { echo "could not read the event count of $scenario, see $dir/log"; exit 1; }
+    rss=nan
+    [ -n "$TIME" ] && rss=$(tail -1 $dir/rss)
+    bytes=$(cat $dir/*.sca $dir/*.vec $dir/*.vci 2>/dev/null | wc -c)
+    awk -v s="$classes,$load,$mode,$recording,$JOBS,$events" -v start=$start -v end=$end -v events=$events -v rss=$rss -v bytes=$bytes \
+        'BEGIN { printf "%s,%.3f,%.0f,%s,%d\n", s, end - start, events / (end - start), rss, bytes }' >>$SUMMARY
+    tail -1 $SUMMARY
+done
+done
+done
+done
+
+[ -z "$SAVE" ] || cp $SUMMARY "$SAVE"
+[ -n "$BASELINE" ] || exit 0
+
+# same scenarios and jobs in both files: the change of events/sec, negative if slower
+awk -F, -v tolerance=$TOLERANCE '
+    NR == 1 { printf "%-40s %12s %12s %8s\n", "classes,load,mode,recording,jobs", "baseline", "events/sec", "change" }
+    FNR == 1 { next }
+    NR == FNR { baseline[$1 "," $2 "," $3 "," $4 "," $5] = $8; next }
+    {
+        key = $1 "," $2 "," $3 "," $4 "," $5
+        if (!(key in baseline)) { printf "%-40s not in the baseline\n", key; next }
+        change = ($8 / baseline[key] - 1) * 100
+        printf "%-40s %12.0f %12.0f %+7.1f%%%s\n", key, baseline[key], $8, change, change < -tolerance ? "  SLOWER" : ""
+        if (change < -tolerance) slower++
+    }
+    END {
+        if (slower) { printf "%d scenarios more than %s%% slower than the baseline\n", slower, tolerance; exit 1 }
+    }' "$BASELINE" $SUMMARY
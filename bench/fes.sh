@@ -0,0 +1,48 @@
+#!/bin/sh
+#
+# Events/sec of the FanIn configuration (N independent Sources into one queue, so N timers pending
+# in the future event set) as N grows, with the default binary heap (cEventHeap) and with the
+# calendar queue (CalendarEventSet); the total load stays that of Net1. Writes results/fes/fes.csv.
+# Run from the project directory, or with "make MODE=release bench-fes":
+#   bench/fes.sh [-p program] [-t sim-time-limit] [sources...]
+#
+PROGRAM=./Project_fast
+LIMIT=100000s
+RESULTS=results/fes
+
+while getopts p:t: opt; do
+    case $opt in
+        p) PROGRAM=$OPTARG ;;
+        t) LIMIT=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+SOURCES=${*:-10 100 1000 10000 100000}
+
+[ -x "$PROGRAM" ] || { echo "build $PROGRAM first (make MODE=release fast)"; exit 1; }
+
+now() { date +%s.%N; }
+
+rm -rf $RESULTS
+mkdir -p $RESULTS
+CSV=$RESULTS/fes.csv
+echo "sources,eventSet,events,seconds,eventsPerSecond" >$CSV
+
+for n in $SOURCES; do
+    for fes in omnetpp::cEventHeap CalendarEventSet; do
+        log=$RESULTS/$n-${fes#omnetpp::}.log
+        start=$(now)
+        $PROGRAM -u Cmdenv -c FanIn -r 0 --sim-time-limit=$LIMIT --cpu-time-limit=0 \
+            --cmdenv-express-mode=true --cmdenv-performance-display=false --result-dir=$RESULTS \
+            "--**.statistic-recording=false" --Net.numSources=$n "--**.gen[*].interArrivalTimes=\"$(awk "BEGIN { print $n * 1.5 }")\"" \
+            "--futureeventset-class=\"$fes\"" >$log 2>&1 \
+            || { echo "run with $n sources and $fes failed, see $log"; exit 1; }
+        end=$(now)
+        events=$(sed -n 's/.*[Ee]vent #\([0-9]*\).*/\1/p' $log | tail -1)
+        [ -n "$events" ] || { echo "could not read the event count, see $log"; exit 1; }
+        awk -v s="$n,${fes#omnetpp::},$events" -v start=$start -v end=$end -v events=$events \
+            'BEGIN { printf "%s,%.3f,%.0f\n", s, end - start, events / (end - start) }' >>$CSV
+        tail -1 $CSV
+    done
+done
@@ -0,0 +1,37 @@
+#!/bin/sh
+#
+# Events/sec of a Cmdenv run with logging on, with logging off at runtime (express mode)
+# and with logging compiled out (Project_fast, "make MODE=release fast").
+# Run from the project directory: bench/logging.sh [config] [sim-time-limit]
+#
+CONFIG=${1:-Net1}
+LIMIT=${2:-1h}
+RUN="-u Cmdenv -c $CONFIG -r 0 --sim-time-limit=$LIMIT --cpu-time-limit=0 --record-eventlog=false"
+
+[ -x ./Project ] && [ -x ./Project_fast ] || { echo "build ./Project and ./Project_fast first (make MODE=release all fast)"; exit 1; }
+
+now() { date +%s.%N; }
+
+# wall-clock seconds of one run, its output discarded
+timed() {
+    start=$(now)
+    "$@" >/dev/null 2>&1 || { echo "run failed: $*" >&2; exit 1; }
+    end=$(now)
+    echo "$end - $start" | bc
+}
+
+# all variants simulate the same events, count them once from an express-mode run
+EVENTS=$(./Project $RUN --cmdenv-express-mode=true --cmdenv-performance-display=false 2>/dev/null \
+         | sed -n 's/.*[Ee]vent #\([0-9]*\).*/\1/p' | tail -1)
+[ -n "$EVENTS" ] || { echo "could not read the event count"; exit 1; }
+
+LOGGING=$(timed ./Project $RUN --cmdenv-express-mode=false --cmdenv-event-banners=false)
+EXPRESS=$(timed ./Project $RUN --cmdenv-express-mode=true)
+FAST=$(timed ./Project_fast $RUN --cmdenv-express-mode=true)
+
+echo "config=$CONFIG events=$EVENTS"
+printf "%-28s %10s %14s\n" "variant" "seconds" "events/sec"
+for v in "logging-on:$LOGGING" "logging-off-runtime:$EXPRESS" "logging-compiled-out:$FAST"; do
+    name=${v%%:*}; secs=${v#*:}
+    printf "%-28s %10.3f %14.0f\n" "$name" "$secs" "$(echo "$EVENTS / $secs" | bc -l)"
+done
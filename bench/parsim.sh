@@ -0,0 +1,88 @@
+#!/bin/sh
+#
+# Parallel scaling of ParallelNet (Source -> Queue -> Sink lanes): runs the ParallelNet configuration
+# sequentially and then split into each number of partitions given, one Cmdenv process per partition
+# talking over named pipes with the null message protocol, and writes results/parsim/scaling.csv
+# with the wall time and the speedup over the sequential run of each.
+# Run from the project directory, or with "make MODE=release bench-parsim":
+#   bench/parsim.sh [-p program] [-l lanes] [-t sim-time-limit] [partitions...]
+# The lanes are split into one block per partition: partition b runs the Sources of block b and the
+# Queues and Sinks of block b-1, like the ParallelNet4 configuration, so every job crosses a 300ms link.
+#
+PROGRAM=./Project_fast
+LANES=200
+LIMIT=1h
+RESULTS=results/parsim
+
+while getopts p:l:t: opt; do
+    case $opt in
+        p) PROGRAM=$OPTARG ;;
+        l) LANES=$OPTARG ;;
+        t) LIMIT=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+CORES=$(nproc 2>/dev/null || echo 1)
+PARTITIONS=${*:-$(p=2; while [ $p -le $CORES ]; do echo $p; p=$((p * 2)); done)}
+
+[ -x "$PROGRAM" ] || { echo "build $PROGRAM first (make MODE=release fast)"; exit 1; }
+
+now() { date +%s.%N; }
+
+rm -rf $RESULTS
+mkdir -p $RESULTS/pipes
+CSV=$RESULTS/scaling.csv
+echo "partitions,lanes,events,seconds,speedup" >$CSV
+RUN="-u Cmdenv -r 0 --sim-time-limit=$LIMIT --cpu-time-limit=0 --cmdenv-express-mode=true --cmdenv-performance-display=false"
+
+# events of the runs whose logs are given, summed over the partitions
+events() {
+    for log; do sed -n 's/.*[Ee]vent #\([0-9]*\).*/\1/p' $log | tail -1; done | awk '{ n += $1 } END { print n }'
+}
+
+# configuration Scaling in $RESULTS/<partitions>.ini: ParallelNet with $LANES lanes, split in $1 partitions
+config() {
+    echo "include $(pwd)/omnetpp.ini"
+    echo "[Config Scaling]"
+    echo "extends = ParallelNet"
+    echo "ParallelNet.numLanes = $LANES"
+    [ $1 -gt 1 ] || return 0
+    echo "parallel-simulation = true"
+    echo "parsim-num-partitions = $1"
+    echo "parsim-communications-class = \"cNamedPipeCommunications\""
+    echo "parsim-synchronization-class = \"cNullMessageProtocol\""
+    echo "parsim-namedpipecommunications-prefix = \"$RESULTS/pipes/\""
+    # block b of the lanes has its Sources in partition b, its Queues and Sinks in partition b+1
+    awk -v p=$1 -v lanes=$LANES 'BEGIN {
+        size = int((lanes + p - 1) / p)
+        for (b = 0; b < p && b * size < lanes; b++) {
+            last = (b + 1) * size - 1 < lanes - 1 ? (b + 1) * size - 1 : lanes - 1
+            printf "ParallelNet.gen[%d..%d].partition-id = %d\n", b * size, last, b
+            printf "ParallelNet.queue[%d..%d].partition-id = %d\n", b * size, last, (b + 1) % p
+            printf "ParallelNet.sink[%d..%d].partition-id = %d\n", b * size, last, (b + 1) % p
+        }
+    }'
+}
+
+SEQUENTIAL=
+for p in 1 $PARTITIONS; do
+    config $p >$RESULTS/$p.ini
+    start=$(now)
+    pids=
+    i=0
+    while [ $i -lt $p ]; do
+        $PROGRAM $RUN -f $RESULTS/$p.ini -c Scaling --parsim-procid=$i --result-dir=$RESULTS/$p >$RESULTS/$p-$i.log 2>&1 &
+        pids="$pids $!"
+        i=$((i + 1))
+    done
+    failed=
+    for pid in $pids; do
+        wait $pid || failed=1
+    done
+    [ -z "$failed" ] || { echo "run with $p partitions failed, see $RESULTS/$p-*.log"; exit 1; }
+    seconds=$(awk -v start=$start -v end=$(now) 'BEGIN { printf "%.3f", end - start }')
+    SEQUENTIAL=${SEQUENTIAL:-$seconds}
+    echo "$p,$LANES,$(events $RESULTS/$p-*.log),$seconds,$(awk -v s=$SEQUENTIAL -v t=$seconds 'BEGIN { printf "%.2f", s / t }')" >>$CSV
+    tail -1 $CSV
+done
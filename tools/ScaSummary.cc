@@ -0,0 +1,161 @@
+//
+// Merges the scalar files of independent replications into one summary with
+// cross-replication confidence intervals: runs of the same experiment and measurement
+// (configuration and iteration variables, the repetition aside) are grouped, and for
+// every scalar the mean over the replications is given with its Student t interval.
+//
+// Standalone program (no simulation kernel needed), built by "make" alongside Project.
+// Usage: ScaSummary [-c confidence] file.sca...   (CSV on stdout)
+//
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <BatchMeans.h>
+
+// splits a line of a .sca file, whose tokens may be quoted with backslash escapes
+static std::vector<std::string> tokenize(const std::string& line)
+{
+    std::vector<std::string> tokens;
+    size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && isspace((unsigned char)line[i]))
+            i++;
+        if (i == line.size())
+            break;
+        std::string token;
+        if (line[i] == '"') {
+            for (i++; i < line.size() && line[i] != '"'; i++) {
+                if (line[i] == '\\' && i + 1 < line.size())
+                    i++;
+                token += line[i];
+            }
+            i++;
+        }
+        else {
+            while (i < line.size() && !isspace((unsigned char)line[i]))
+                token += line[i++];
+        }
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+struct Run {
+    std::string experiment, measurement;
+    std::vector<std::tuple<std::string, std::string, double>> scalars; // module, name, value
+};
+
+static bool readRuns(const char *fileName, std::vector<Run>& runs)
+{
+    std::ifstream in(fileName);
+    if (!in)
+        return false;
+    std::string line, statistic;
+    while (std::getline(in, line)) {
+        std::vector<std::string> t = tokenize(line);
+        if (t.empty())
+            continue;
+        if (t[0] == "run") {
+            runs.push_back(Run());
+            statistic.clear();
+        }
+        else if (runs.empty())
+            continue;
+        else if (t[0] == "attr" && t.size() == 3 && statistic.empty() && runs.back().scalars.empty()) {
+            if (t[1] == "experiment")
+                runs.back().experiment = t[2];
+            else if (t[1] == "measurement")
+                runs.back().measurement = t[2];
+        }
+        else if (t[0] == "scalar" && t.size() == 4) {
+            runs.back().scalars.emplace_back(t[1], t[2], atof(t[3].c_str()));
+            statistic.clear();
+        }
+        else if (t[0] == "statistic" && t.size() == 3)
+            statistic = t[1] + " " + t[2];
+        else if (t[0] == "field" && t.size() == 3 && !statistic.empty()) {
+            size_t space = statistic.find(' ');
+            runs.back().scalars.emplace_back(statistic.substr(0, space), statistic.substr(space + 1) + ":" + t[1], atof(t[2].c_str()));
+        }
+        else if (t[0] == "vector" || t[0] == "histogram")
+            statistic.clear();
+    }
+    return true;
+}
+
+static std::string csv(const std::string& s)
+{
+    if (s.find_first_of(",\"") == std::string::npos)
+        return s;
+    std::string quoted = "\"";
+    for (char c : s)
+        quoted += c == '"' ? std::string("\"\"") : std::string(1, c);
+    return quoted + "\"";
+}
+
+// the runs of a class without any job served record NaN, print them the same way whatever their sign
+static std::string number(double x)
+{
+    if (std::isnan(x))
+        return "nan";
+    char buf[32];
+    sprintf(buf, "%.10g", x);
+    return buf;
+}
+
+int main(int argc, char **argv)
+{
+    double confidence = 0.95;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "-c") == 0) {
+        confidence = atof(argv[2]);
+        first = 3;
+    }
+    if (first >= argc || confidence <= 0 || confidence >= 1) {
+        fprintf(stderr, "usage: %s [-c confidence] file.sca...\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Run> runs;
+    for (int i = first; i < argc; i++) {
+        if (!readRuns(argv[i], runs)) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    // experiment, measurement, module, scalar -> one value per replication, in file order
+    typedef std::tuple<std::string, std::string, std::string, std::string> Key;
+    std::map<Key, std::vector<double>> values;
+    for (auto& run : runs)
+        for (auto& scalar : run.scalars)
+            values[Key(run.experiment, run.measurement, std::get<0>(scalar), std::get<1>(scalar))].push_back(std::get<2>(scalar));
+
+    printf("experiment,measurement,module,name,replications,mean,stddev,halfWidth,low,high\n");
+    for (auto& entry : values) {
+        const std::vector<double>& v = entry.second;
+        int n = v.size();
+        double sum = 0;
+        for (double x : v)
+            sum += x;
+        double mean = sum / n;
+        double sqrDev = 0;
+        for (double x : v)
+            sqrDev += (x - mean) * (x - mean);
+        double stddev = n > 1 ? sqrt(sqrDev / (n - 1)) : NAN;
+        double halfWidth = n > 1 ? BatchMeans::studentQuantile((1 + confidence) / 2, n - 1) * stddev / sqrt(n) : NAN;
+        printf("%s,%s,%s,%s,%d,%s,%s,%s,%s,%s\n",
+               csv(std::get<0>(entry.first)).c_str(), csv(std::get<1>(entry.first)).c_str(),
+               csv(std::get<2>(entry.first)).c_str(), csv(std::get<3>(entry.first)).c_str(), n,
+               number(mean).c_str(), number(stddev).c_str(), number(halfWidth).c_str(),
+               number(mean - halfWidth).c_str(), number(mean + halfWidth).c_str());
+    }
+    return 0;
+}
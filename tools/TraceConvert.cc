@@ -0,0 +1,68 @@
+//
+// Converts a text arrival trace into the binary format replayed by Source (traceFile
+// parameter, see TraceReader.h). Each input line is "time priority [serviceDemand]",
+// times in seconds from the start of the trace; lines starting with # are skipped.
+//
+// Standalone program (no simulation kernel needed), built by "make" alongside Project.
+// Usage: TraceConvert input.txt output.trace
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <TraceReader.h>
+
+int main(int argc, char **argv)
+{
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s input.txt output.trace\n", argv[0]);
+        return 1;
+    }
+    FILE *in = fopen(argv[1], "r");
+    if (!in) {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+    FILE *out = fopen(argv[2], "wb");
+    if (!out) {
+        fprintf(stderr, "cannot create %s\n", argv[2]);
+        return 1;
+    }
+
+    TraceHeader header;
+    memcpy(header.magic, "PRIOTRC1", 8);
+    header.version = 1;
+    header.recordSize = sizeof(TraceRecord);
+    header.numRecords = 0;
+    fwrite(&header, sizeof(header), 1, out); // rewritten with the count at the end
+
+    char line[256];
+    long lineNumber = 0;
+    double lastTime = 0;
+    while (fgets(line, sizeof(line), in)) {
+        lineNumber++;
+        double time, demand = 0;
+        int priority;
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0')
+            continue;
+        int fields = sscanf(line, "%lf %d %lf", &time, &priority, &demand);
+        if (fields < 2 || time < lastTime || priority < 0 || priority > 65535 || demand < 0) {
+            fprintf(stderr, "%s:%ld: expected \"time priority [serviceDemand]\" with non-decreasing times\n", argv[1], lineNumber);
+            return 1;
+        }
+        TraceRecord record = {time, (float)demand, (uint16_t)priority, 0};
+        fwrite(&record, sizeof(record), 1, out);
+        header.numRecords++;
+        lastTime = time;
+    }
+    fclose(in);
+
+    fseek(out, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, out);
+    if (fclose(out) != 0) {
+        fprintf(stderr, "cannot write %s\n", argv[2]);
+        return 1;
+    }
+    printf("%llu records, %g s\n", (unsigned long long)header.numRecords, lastTime);
+    return 0;
+}
@@ -0,0 +1,66 @@
+#!/bin/sh
+#
+# Runs independent replications of the given configurations on all the cores and merges
+# their scalars into one summary with cross-replication confidence intervals.
+# Every replication has its own seed set (seed-set = ${repetition} in omnetpp.ini).
+# Run from the project directory, or with "make MODE=release replications":
+#   tools/replications.sh [-n replications] [-j jobs] [-p program] [config...] [-- extra args]
+# Iteration variables in omnetpp.ini (e.g. a load sweep) multiply the runs; each
+# combination gets its own rows in the summary.
+#
+N=10
+JOBS=$(nproc 2>/dev/null || sysctl -n hw.ncpu 2>/dev/null || echo 1)
+PROGRAM=./Project_fast
+SCA_SUMMARY=${SCA_SUMMARY:-out/gcc-release/tools/ScaSummary}
+RESULTS=results/replications
+
+while getopts n:j:p: opt; do
+    case $opt in
+        n) N=$OPTARG ;;
+        j) JOBS=$OPTARG ;;
+        p) PROGRAM=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+CONFIGS=
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+    CONFIGS="$CONFIGS $1"; shift
+done
+[ "$1" = "--" ] && shift
+CONFIGS=${CONFIGS:-Net1 Net2 Net3}
+
+[ -x "$PROGRAM" ] || { echo "build $PROGRAM first (make MODE=release fast)"; exit 1; }
+[ -x "$SCA_SUMMARY" ] || { echo "build $SCA_SUMMARY first (make MODE=release replications)"; exit 1; }
+
+rm -rf $RESULTS
+mkdir -p $RESULTS
+# the runs of all the configurations, one "config run" line each, so that one pool of $JOBS
+# keeps every core busy until the last run instead of waiting for the slowest run of each config
+for c in $CONFIGS; do
+    runs=$($PROGRAM -s -u Cmdenv -c $c --repeat=$N -q runnumbers "$@") \
+        || { echo "cannot list the runs of $c"; exit 1; }
+    for r in $runs; do
+        echo "$c $r"
+    done
+done >$RESULTS/runs.txt
+
+export PROGRAM RESULTS N
+start=$(date +%s)
+# every run logs to config-run.log and writes its wall time in seconds to config-run.time
+xargs -P$JOBS -I{} sh -c 'set -- {} "$@"; c=$1 r=$2; shift 2
+    s=$(date +%s)
+    $PROGRAM -u Cmdenv -c $c -r $r --repeat=$N --result-dir=$RESULTS \
+        --cmdenv-express-mode=true --cmdenv-performance-display=false "$@" >$RESULTS/$c-$r.log 2>&1 \
+        || { echo "run $r of $c failed, see $RESULTS/$c-$r.log"; exit 1; }
+    echo $(($(date +%s) - s)) >$RESULTS/$c-$r.time' sh "$@" <$RESULTS/runs.txt \
+    || exit 1
+end=$(date +%s)
+
+$SCA_SUMMARY $RESULTS/*.sca >$RESULTS/summary.csv || exit 1
+# speedup: the wall time of the runs one after the other over the wall time of the pool
+cat $RESULTS/*.time | awk -v runs=$(wc -l <$RESULTS/runs.txt) -v jobs=$JOBS -v wall=$((end - start)) \
+    -v configs="$CONFIGS" -v results=$RESULTS '
+    { serial += $1 }
+    END { printf "%d runs of%s on %d cores in %ds (%ds one after the other, speedup %.1f), summary in %s/summary.csv\n",
+          runs, configs, jobs, wall, serial, (wall > 0 ? serial / wall : 1), results }'